@@ -0,0 +1,60 @@
+#include "Bench.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+// nearest-rank percentile of sorted samples
+double percentile(const std::vector<double>& sorted, double p) {
+    size_t rank = (size_t)std::ceil(p / 100.0 * sorted.size());
+    return sorted[rank ? rank - 1 : 0];
+}
+
+volatile unsigned long long sink; // keeps benchmark results alive
+
+} // namespace
+
+void BenchSuite::add(const std::string& name, size_t ops, std::function<BenchLoop()> setup) {
+    benchmarks.push_back({name, ops, std::move(setup)});
+}
+
+void BenchSuite::list() const {
+    for (const Benchmark& bench : benchmarks) std::cout << bench.name << "\n";
+}
+
+size_t BenchSuite::run(const BenchOptions& options) const {
+    std::cout << std::left << std::setw(44) << "Benchmark" << std::right
+              << std::setw(10) << "Ops/rep" << std::setw(12) << "Mops/s"
+              << std::setw(10) << "p50 ns" << std::setw(10) << "p90 ns" << std::setw(10) << "p99 ns"
+              << std::setw(10) << "min ns" << "\n";
+
+    size_t count = 0;
+    for (const Benchmark& bench : benchmarks) {
+        if (!options.filter.empty() && bench.name.find(options.filter) == std::string::npos) continue;
+
+        size_t ops = std::max<size_t>(1, (size_t)(bench.ops * options.scale));
+        BenchLoop loop = bench.setup();
+        for (size_t i = 0; i < options.warmup; ++i) sink = sink + loop(ops);
+
+        std::vector<double> ns_per_op;
+        for (size_t i = 0; i < options.repetitions; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            unsigned long long result = loop(ops);
+            auto end = std::chrono::steady_clock::now();
+            sink = sink + result;
+            ns_per_op.push_back(std::chrono::duration<double, std::nano>(end - start).count() / ops);
+        }
+        std::sort(ns_per_op.begin(), ns_per_op.end());
+
+        double median = percentile(ns_per_op, 50);
+        std::cout << std::left << std::setw(44) << bench.name << std::right << std::fixed
+                  << std::setw(10) << ops << std::setprecision(2) << std::setw(12) << (median > 0 ? 1e3 / median : 0.0)
+                  << std::setprecision(1) << std::setw(10) << median << std::setw(10) << percentile(ns_per_op, 90)
+                  << std::setw(10) << percentile(ns_per_op, 99) << std::setw(10) << ns_per_op.front() << std::endl;
+        count++;
+    }
+    return count;
+}
@@ -0,0 +1,72 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Cheap deterministic generator (xorshift64*), so the benchmarks measure the simulator, not the RNG
+class XorShift {
+private:
+    uint64_t state;
+
+public:
+    explicit XorShift(uint64_t seed) : state(seed ? seed : 0x9E3779B97F4A7C15ULL) {}
+
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1DULL;
+    }
+    // uniform in [0, n)
+    uint64_t below(uint64_t n) { return next() % n; }
+};
+
+struct BenchOptions {
+    size_t warmup;        // unmeasured repetitions before the measured ones
+    size_t repetitions;   // measured repetitions; percentiles are taken over these
+    double scale;         // multiplies the operations per repetition
+    std::string filter;   // run only benchmarks whose name contains this text
+
+    BenchOptions() : warmup(2), repetitions(15), scale(1.0) {}
+};
+
+// Performs n operations and returns a value derived from them, so the work cannot be optimized away.
+// State (heap contents, cache lines, page table) persists from one repetition to the next.
+using BenchLoop = std::function<unsigned long long(size_t n)>;
+
+/**
+ * @brief Runs registered micro-benchmarks and reports ops/sec and ns/op percentiles.
+ *
+ * Each benchmark is set up right before it runs (so only one simulator instance is alive at a
+ * time), warmed up, then timed for a number of repetitions of a fixed operation count. The
+ * report shows the median throughput and the p50/p90/p99/min of the per-repetition ns/op.
+ */
+class BenchSuite {
+private:
+    struct Benchmark {
+        std::string name;
+        size_t ops;                           // operations per repetition at scale 1
+        std::function<BenchLoop()> setup;
+    };
+    std::vector<Benchmark> benchmarks;
+
+public:
+    void add(const std::string& name, size_t ops, std::function<BenchLoop()> setup);
+
+    void list() const;
+    // returns the number of benchmarks that were run
+    size_t run(const BenchOptions& options) const;
+};
+
+void registerAllocatorBenchmarks(BenchSuite& suite);
+void registerTranslationBenchmarks(BenchSuite& suite);
+void registerCacheBenchmarks(BenchSuite& suite);
+void registerConcurrentBenchmarks(BenchSuite& suite);
+
+// memsim_bench --stress: multi-threaded throughput scaling and lock contention table
+void runStressReport(const BenchOptions& options, const std::string& algo);
+
+#endif // BENCH_H
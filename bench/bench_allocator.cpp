@@ -0,0 +1,61 @@
+#include "Bench.h"
+#include "../include/MemoryManager.h"
+#include <memory>
+
+namespace {
+
+const size_t MIN_REQUEST = 16;
+const size_t MAX_REQUEST = 512;
+
+// Steady-state churn: the heap is filled to about half, then every pair of operations frees a
+// random live block and allocates a new one of random size.
+BenchLoop allocatorChurn(const std::string& strategy, size_t heap_size) {
+    auto heap = std::make_shared<MemoryManager>();
+    auto live = std::make_shared<std::vector<int>>();
+    auto rng = std::make_shared<XorShift>(heap_size);
+
+    heap->setVerbose(false);
+    heap->setAllocator(strategy);
+    heap->init(heap_size);
+
+    size_t filled = 0;
+    while (filled < heap_size / 2) {
+        size_t size = MIN_REQUEST + rng->below(MAX_REQUEST - MIN_REQUEST + 1);
+        int id = heap->my_malloc(size);
+        if (id < 0) break;
+        live->push_back(id);
+        filled += size;
+    }
+
+    return [heap, live, rng](size_t n) {
+        unsigned long long checksum = 0;
+        for (size_t i = 0; i + 1 < n; i += 2) {
+            if (!live->empty()) {
+                size_t victim = rng->below(live->size());
+                heap->my_free((*live)[victim]);
+                (*live)[victim] = live->back();
+                live->pop_back();
+            }
+            int id = heap->my_malloc(MIN_REQUEST + rng->below(MAX_REQUEST - MIN_REQUEST + 1));
+            if (id >= 0) live->push_back(id);
+            checksum += id;
+        }
+        return checksum;
+    };
+}
+
+} // namespace
+
+void registerAllocatorBenchmarks(BenchSuite& suite) {
+    const char* strategies[] = {"first_fit", "best_fit", "worst_fit", "tlsf", "buddy", "slab"};
+    const struct { const char* label; size_t size; } heaps[] = {{"64KB", 1 << 16}, {"1MB", 1 << 20}, {"16MB", 1 << 24}};
+
+    for (const char* strategy : strategies) {
+        for (const auto& heap : heaps) {
+            std::string name = std::string("alloc/") + strategy + "/" + heap.label;
+            std::string algo = strategy;
+            size_t size = heap.size;
+            suite.add(name, 200000, [algo, size]() { return allocatorChurn(algo, size); });
+        }
+    }
+}
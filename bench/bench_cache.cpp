@@ -0,0 +1,58 @@
+#include "Bench.h"
+#include "../include/Cache.h"
+#include <memory>
+
+namespace {
+
+const size_t BLOCK_SIZE = 64;
+const size_t STREAM_LENGTH = 1 << 20;
+
+// accesses span 4x the cache capacity: sequential in block steps, or uniformly random
+BenchLoop cacheLoop(size_t size, size_t assoc, ReplacementPolicy policy, bool random) {
+    auto cache = std::make_shared<CacheLevel>("bench", size, BLOCK_SIZE, assoc, policy);
+    auto addresses = std::make_shared<std::vector<unsigned long long>>(STREAM_LENGTH);
+    auto next = std::make_shared<size_t>(0);
+
+    XorShift rng(size + assoc);
+    const size_t span = 4 * size;
+    for (size_t i = 0; i < STREAM_LENGTH; ++i) {
+        (*addresses)[i] = random ? rng.below(span) : (i * BLOCK_SIZE) % span;
+    }
+
+    return [cache, addresses, next](size_t n) {
+        unsigned long long hits = 0;
+        size_t pos = *next;
+        for (size_t i = 0; i < n; ++i) {
+            hits += cache->access((*addresses)[pos]);
+            if (++pos == addresses->size()) pos = 0;
+        }
+        *next = pos;
+        return hits;
+    };
+}
+
+} // namespace
+
+void registerCacheBenchmarks(BenchSuite& suite) {
+    const struct { const char* label; size_t size; size_t assoc; } geometries[] = {
+        {"1KB/2way", 1 << 10, 2},
+        {"32KB/8way", 32 << 10, 8},
+        {"256KB/16way", 256 << 10, 16},
+        {"8MB/16way", 8 << 20, 16},
+    };
+    const struct { const char* label; ReplacementPolicy policy; } policies[] = {
+        {"lru", ReplacementPolicy::LRU}, {"fifo", ReplacementPolicy::FIFO}};
+
+    for (const auto& geometry : geometries) {
+        for (const auto& policy : policies) {
+            for (bool random : {false, true}) {
+                std::string name = std::string("cache/") + geometry.label + "/" + policy.label
+                                 + (random ? "/random" : "/sequential");
+                size_t size = geometry.size;
+                size_t assoc = geometry.assoc;
+                ReplacementPolicy p = policy.policy;
+                suite.add(name, 1000000, [size, assoc, p, random]() { return cacheLoop(size, assoc, p, random); });
+            }
+        }
+    }
+}
@@ -0,0 +1,149 @@
+#include "Bench.h"
+#include "../include/ConcurrentHeap.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+namespace {
+
+const size_t MIN_REQUEST = 16;
+const size_t MAX_REQUEST = 512;
+const size_t HEAP_SIZE = 1 << 24;
+
+// One heap shared by every worker; each worker owns its live blocks (and its ThreadCache).
+// cached == false: workers call MemoryManager::my_malloc/my_free directly under the heap lock.
+struct SharedHeap {
+    MemoryManager heap;
+    std::unique_ptr<ConcurrentHeap> front;
+    std::vector<std::unique_ptr<ThreadCache>> caches;
+    std::vector<std::vector<int>> live;
+    std::vector<XorShift> rngs;
+
+    SharedHeap(const std::string& algo, size_t threads, bool cached) {
+        heap.setVerbose(false);
+        heap.setAllocator(algo);
+        heap.init(HEAP_SIZE);
+        if (cached) front = std::make_unique<ConcurrentHeap>(heap);
+        for (size_t t = 0; t < threads; ++t) {
+            if (front) caches.push_back(std::make_unique<ThreadCache>(*front));
+            live.emplace_back();
+            rngs.emplace_back(t + 1);
+        }
+        // a quarter of the heap live, split evenly between the workers
+        size_t per_thread = HEAP_SIZE / 4 / threads;
+        for (size_t t = 0; t < threads; ++t) {
+            for (size_t filled = 0; filled < per_thread;) {
+                size_t size = MIN_REQUEST + rngs[t].below(MAX_REQUEST - MIN_REQUEST + 1);
+                int id = allocate(t, size);
+                if (id < 0) break;
+                live[t].push_back(id);
+                filled += size;
+            }
+        }
+    }
+
+    int allocate(size_t t, size_t size) { return front ? caches[t]->malloc(size) : heap.my_malloc(size); }
+    void release(size_t t, int id) {
+        if (front) {
+            caches[t]->free(id);
+        } else {
+            heap.my_free(id);
+        }
+    }
+
+    // free a random live block, allocate a new one; n operations
+    unsigned long long churn(size_t t, size_t n) {
+        std::vector<int>& blocks = live[t];
+        XorShift& rng = rngs[t];
+        unsigned long long checksum = 0;
+        for (size_t i = 0; i + 1 < n; i += 2) {
+            if (!blocks.empty()) {
+                size_t victim = rng.below(blocks.size());
+                release(t, blocks[victim]);
+                blocks[victim] = blocks.back();
+                blocks.pop_back();
+            }
+            int id = allocate(t, MIN_REQUEST + rng.below(MAX_REQUEST - MIN_REQUEST + 1));
+            if (id >= 0) blocks.push_back(id);
+            checksum += id;
+        }
+        return checksum;
+    }
+
+    // n operations split across the workers, all started together
+    unsigned long long run(size_t n) {
+        size_t threads = live.size();
+        std::vector<unsigned long long> sums(threads);
+        std::vector<std::thread> pool;
+        for (size_t t = 0; t < threads; ++t) {
+            pool.emplace_back([this, t, n, threads, &sums]() { sums[t] = churn(t, n / threads); });
+        }
+        unsigned long long checksum = 0;
+        for (size_t t = 0; t < threads; ++t) {
+            pool[t].join();
+            checksum += sums[t];
+        }
+        return checksum;
+    }
+};
+
+const size_t THREAD_COUNTS[] = {1, 2, 4, 8};
+
+} // namespace
+
+void registerConcurrentBenchmarks(BenchSuite& suite) {
+    const char* strategies[] = {"first_fit", "buddy"};
+    for (const char* mode : {"locked", "cached"}) {
+        for (const char* strategy : strategies) {
+            for (size_t threads : THREAD_COUNTS) {
+                std::string name = std::string("mt/") + mode + "/" + strategy + "/t" + std::to_string(threads);
+                std::string algo = strategy;
+                bool cached = std::string(mode) == "cached";
+                suite.add(name, 400000, [algo, threads, cached]() {
+                    auto shared = std::make_shared<SharedHeap>(algo, threads, cached);
+                    return BenchLoop([shared](size_t n) { return shared->run(n); });
+                });
+            }
+        }
+    }
+}
+
+// Throughput scaling and lock contention of the shared heap, with and without thread caches
+void runStressReport(const BenchOptions& options, const std::string& algo) {
+    size_t ops = std::max<size_t>(1000, (size_t)(2000000 * options.scale));
+    std::cout << "Shared " << algo << " heap (" << HEAP_SIZE << " bytes), " << ops
+              << " malloc/free operations per run, " << std::thread::hardware_concurrency() << " hardware threads\n"
+              << std::left << std::setw(8) << "Mode" << std::right << std::setw(8) << "Threads"
+              << std::setw(10) << "Mops/s" << std::setw(10) << "Speedup" << std::setw(12) << "Cache hit%"
+              << std::setw(14) << "Central waits" << std::setw(12) << "Heap waits" << "\n";
+
+    for (bool cached : {false, true}) {
+        double base = 0.0;
+        for (size_t threads : THREAD_COUNTS) {
+            SharedHeap shared(algo, threads, cached);
+            size_t waits_before = shared.heap.getLockContention();
+            shared.run(ops / 10); // warm the caches and the free lists
+
+            auto start = std::chrono::steady_clock::now();
+            shared.run(ops);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            double mops = seconds > 0 ? ops / seconds / 1e6 : 0.0;
+            if (threads == 1) base = mops;
+            std::cout << std::left << std::setw(8) << (cached ? "cached" : "locked") << std::right << std::setw(8)
+                      << threads << std::fixed << std::setprecision(2) << std::setw(10) << mops
+                      << std::setw(10) << (base > 0 ? mops / base : 0.0);
+            if (cached) {
+                for (auto& cache : shared.caches) cache->flush();
+                ConcurrentHeapStats stats = shared.front->getStats();
+                double hits = stats.mallocs ? 100.0 * stats.thread_cache_hits / stats.mallocs : 0.0;
+                std::cout << std::setw(12) << hits << std::setw(14) << stats.central_contention;
+            } else {
+                std::cout << std::setw(12) << "-" << std::setw(14) << "-";
+            }
+            std::cout << std::setw(12) << shared.heap.getLockContention() - waits_before << std::endl;
+        }
+    }
+}
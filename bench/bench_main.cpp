@@ -0,0 +1,71 @@
+#include "Bench.h"
+#include <iostream>
+#include <string>
+
+void printBenchUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [--filter <text>] [--reps <n>] [--warmup <n>] [--scale <x>] [--list]\n"
+              << "       " << prog << " --stress [first_fit|best_fit|worst_fit|tlsf|buddy|slab] [--scale <x>]\n"
+              << "  --filter   run only benchmarks whose name contains text (e.g. alloc/buddy, translate, cache/32KB)\n"
+              << "  --reps     measured repetitions per benchmark (default 15)\n"
+              << "  --warmup   unmeasured repetitions first (default 2)\n"
+              << "  --scale    multiply the operations per repetition (e.g. 0.1 for a quick run)\n"
+              << "  --stress   1-8 threads on one shared heap, with and without thread caches:\n"
+              << "             throughput, speedup and lock contention\n";
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    bool list_only = false;
+    std::string stress_algo;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        try {
+            if (arg == "--filter" && i + 1 < argc) {
+                options.filter = argv[++i];
+            } else if (arg == "--reps" && i + 1 < argc) {
+                options.repetitions = std::stoull(argv[++i]);
+            } else if (arg == "--warmup" && i + 1 < argc) {
+                options.warmup = std::stoull(argv[++i]);
+            } else if (arg == "--scale" && i + 1 < argc) {
+                options.scale = std::stod(argv[++i]);
+            } else if (arg == "--list") {
+                list_only = true;
+            } else if (arg == "--stress") {
+                stress_algo = "first_fit";
+                if (i + 1 < argc && argv[i + 1][0] != '-') stress_algo = argv[++i];
+            } else {
+                printBenchUsage(argv[0]);
+                return 1;
+            }
+        } catch (...) {
+            printBenchUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (options.repetitions == 0 || options.scale <= 0.0) {
+        printBenchUsage(argv[0]);
+        return 1;
+    }
+
+    if (!stress_algo.empty()) {
+        runStressReport(options, stress_algo);
+        return 0;
+    }
+
+    BenchSuite suite;
+    registerAllocatorBenchmarks(suite);
+    registerTranslationBenchmarks(suite);
+    registerCacheBenchmarks(suite);
+    registerConcurrentBenchmarks(suite);
+
+    if (list_only) {
+        suite.list();
+        return 0;
+    }
+    if (suite.run(options) == 0) {
+        std::cerr << "Error: No benchmark matches '" << options.filter << "'" << std::endl;
+        return 1;
+    }
+    return 0;
+}
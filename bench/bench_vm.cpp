@@ -0,0 +1,49 @@
+#include "Bench.h"
+#include "../include/PageTable.h"
+#include <memory>
+
+namespace {
+
+const size_t PAGE_SIZE = 4096;
+const size_t PHYS_SIZE = 16 << 20;     // 4096 frames
+const size_t STREAM_LENGTH = 1 << 20;  // addresses generated up front, replayed cyclically
+
+// pages = 0: sequential walk over 4x physical memory in 64B steps (one fault per page)
+// otherwise: uniform random accesses over that many pages
+BenchLoop translateLoop(size_t pages) {
+    auto vm = std::make_shared<VirtualMemoryManager>(PHYS_SIZE, PAGE_SIZE, 0, false);
+    auto addresses = std::make_shared<std::vector<unsigned long long>>(STREAM_LENGTH);
+    auto next = std::make_shared<size_t>(0);
+
+    XorShift rng(pages + 1);
+    for (size_t i = 0; i < STREAM_LENGTH; ++i) {
+        (*addresses)[i] = pages ? rng.below(pages * PAGE_SIZE) : (i * 64) % (4 * PHYS_SIZE);
+    }
+
+    return [vm, addresses, next](size_t n) {
+        unsigned long long checksum = 0;
+        size_t pos = *next;
+        for (size_t i = 0; i < n; ++i) {
+            checksum += vm->translate((*addresses)[pos]);
+            if (++pos == addresses->size()) pos = 0;
+        }
+        *next = pos;
+        return checksum;
+    };
+}
+
+} // namespace
+
+void registerTranslationBenchmarks(BenchSuite& suite) {
+    const struct { const char* label; size_t pages; } patterns[] = {
+        {"sequential", 0},              // streaming: TLB and page faults once per page
+        {"random_64KB", 16},            // fits the L1 dTLB
+        {"random_4MB", 1024},           // needs the STLB
+        {"random_16MB", 4096},          // fits physical memory, misses the TLB
+        {"random_64MB_thrash", 16384},  // 4x physical memory: mostly page faults
+    };
+    for (const auto& pattern : patterns) {
+        size_t pages = pattern.pages;
+        suite.add(std::string("translate/") + pattern.label, 1000000, [pages]() { return translateLoop(pages); });
+    }
+}
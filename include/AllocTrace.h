@@ -0,0 +1,111 @@
+#ifndef ALLOC_TRACE_H
+#define ALLOC_TRACE_H
+
+#include "Workload.h"
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Binary allocation trace (little-endian, version 1):
+ *
+ *   header  24 bytes: "MSAT", u32 version, u64 record count, u64 handle count (max handle + 1)
+ *   record  21 bytes: u8 op (0 malloc, 1 free, 2 realloc), u32 handle, u64 size, u64 timestamp
+ *
+ * Handles are chosen by the producer and should be dense (reused after their free), so a replay
+ * maps them to block IDs with a flat array of handle-count entries. The reader rejects headers
+ * claiming more handles than records; replay skips records whose handle is out of range and
+ * maps very large handle counts through a hash map instead.
+ */
+struct AllocTraceHeader {
+    uint64_t records;
+    uint64_t handles;
+};
+
+class AllocTraceWriter {
+private:
+    FILE* file;
+    std::vector<unsigned char> buffer;
+    AllocTraceHeader header;
+
+    void flush();
+
+public:
+    AllocTraceWriter();
+    ~AllocTraceWriter();
+
+    AllocTraceWriter(const AllocTraceWriter&) = delete;
+    AllocTraceWriter& operator=(const AllocTraceWriter&) = delete;
+
+    // creates/truncates path; false (with a message) if it cannot be written
+    bool open(const std::string& path);
+    bool isOpen() const { return file != nullptr; }
+    void write(const AllocOp& op);
+    // writes the final header; returns the number of records written
+    uint64_t close();
+};
+
+class AllocTraceReader {
+private:
+    FILE* file;
+    std::vector<unsigned char> buffer;
+    AllocTraceHeader header;
+    uint64_t remaining;
+
+public:
+    explicit AllocTraceReader(const std::string& path);
+    ~AllocTraceReader();
+
+    AllocTraceReader(const AllocTraceReader&) = delete;
+    AllocTraceReader& operator=(const AllocTraceReader&) = delete;
+
+    // false (with a message) if the file is missing, not a trace or of another version
+    bool isOpen() const { return file != nullptr; }
+    const AllocTraceHeader& getHeader() const { return header; }
+
+    // decodes up to max records; 0 at end of trace
+    size_t readBatch(AllocOp* out, size_t max);
+};
+
+struct AllocImportStats {
+    size_t lines;
+    size_t records;
+    size_t skipped;        // lines without a record: unparseable, failed (NULL) allocations, free(NULL), unknown frees
+    size_t unknown_frees;  // free/realloc of a pointer never allocated in the log (subset of skipped for frees)
+
+    AllocImportStats() : lines(0), records(0), skipped(0), unknown_frees(0) {}
+};
+
+/**
+ * @brief Converts a text allocation log into the binary format.
+ *
+ * Accepted lines (an optional leading timestamp, integer ticks or decimal seconds, is kept;
+ * otherwise the line number is used):
+ *   malloc(32) = 0x55d0c0            calloc(4, 8) = 0x..      realloc(0x55d0c0, 64) = 0x..      free(0x55d0c0)
+ *   malloc <size> [handle]           free <handle>            realloc <handle> <size>
+ * The first form matches ltrace/LD_PRELOAD logs (anything before the call, e.g. a pid, is ignored).
+ * In the second, a malloc without a handle gets the next sequential ID starting at 1, like the
+ * block IDs of a CLI script. Pointers/handles of any width are renumbered to dense handles.
+ */
+class AllocLogImporter {
+private:
+    std::unordered_map<unsigned long long, uint32_t> live; // log pointer/handle -> dense handle
+    std::vector<uint32_t> free_handles;
+    uint32_t next_handle;
+    unsigned long long next_sequential_id;
+    AllocImportStats stats;
+
+    uint32_t bind(unsigned long long key);
+    // false if key is not live
+    bool release(unsigned long long key, uint32_t& handle);
+    bool parseLine(const std::string& line, AllocOp& op);
+
+public:
+    AllocLogImporter() : next_handle(0), next_sequential_id(1) {}
+
+    bool run(const std::string& text_path, const std::string& trace_path);
+    const AllocImportStats& getStats() const { return stats; }
+};
+
+#endif // ALLOC_TRACE_H
@@ -5,6 +5,8 @@
 #include <string>
 
 // abstract Base Class for Allocation Strategies
+// Each strategy keeps its own index of the free blocks (segregated by size)
+// alongside the address-ordered block list owned by MemoryManager.
 class Allocator {
 public:
     virtual ~Allocator() = default;
@@ -12,11 +14,19 @@ public:
     /**
      * @brief Finds a suitable free block for the requested size.
      * 
-     * @param head Pointer to the head of the memory block list.
      * @param size Size of memory requested.
      * @return Block* Pointer to the suitable free block, or nullptr if none found.
      */
-    virtual Block* findFreeBlock(Block* head, size_t size) = 0;
+    virtual Block* findFreeBlock(size_t size) = 0;
+
+    /**
+     * @brief Free-block index maintenance.
+     * MemoryManager calls these whenever a block becomes free or stops being free.
+     * A free block must be removed before its size or address changes and re-added after.
+     */
+    virtual void addFreeBlock(Block* block) = 0;
+    virtual void removeFreeBlock(Block* block) = 0;
+    virtual void clear() = 0;
 
     virtual std::string getName() const = 0;
 };
@@ -3,22 +3,109 @@
 
 #include "Allocator.h"
 #include "Block.h"
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
 
+// First Fit: power-of-2 size-class bins. Every block in a bin above the request's class fits, so
+// only the lowest-addressed block of each of those bins is compared. Within a bin, blocks sit in an
+// address-ordered treap whose nodes also record the largest block size in their subtree, so the
+// lowest-addressed fit in the request's own class is found in O(log n) without a scan.
 class FirstFit : public Allocator {
+private:
+    static const int NUM_BINS = 64;
+
+    struct Node {
+        Block* block;
+        size_t max_size;    // largest block size in this subtree
+        uint32_t priority;  // heap order on random priorities keeps the tree balanced
+        int left, right;    // indices into nodes, -1 if none
+    };
+
+    std::vector<Node> nodes;      // shared by all bins
+    std::vector<int> free_nodes;  // recycled node indices
+    int roots[NUM_BINS];
+    Block* lowest[NUM_BINS];      // lowest-addressed block of each bin
+    uint64_t non_empty_bins;      // bit i set if bins[i] has blocks
+    uint32_t rng_state;
+
+    // address order; zero-sized blocks can share a start address with their neighbours
+    static bool before(const Block* a, const Block* b);
+    uint32_t nextPriority();
+    void update(int n);
+    // left: keys before key, right: the rest
+    void split(int n, const Block* key, int& left, int& right);
+    int merge(int left, int right);
+    int insert(int n, int item);
+    int erase(int n, const Block* block);
+    // lowest-addressed block of at least size in the tree at n, nullptr if none
+    Block* lowestFit(int n, size_t size) const;
+
 public:
-    Block* findFreeBlock(Block* head, size_t size) override;
+    FirstFit();
+    Block* findFreeBlock(size_t size) override;
+    void addFreeBlock(Block* block) override;
+    void removeFreeBlock(Block* block) override;
+    void clear() override;
     std::string getName() const override;
 };
 
-class BestFit : public Allocator {
+// Free blocks ordered by (size, address), shared by Best Fit and Worst Fit.
+// Ties on size resolve to the lowest address, same as a scan from the list head.
+class SizeOrderedAllocator : public Allocator {
+protected:
+    std::multimap<std::pair<size_t, size_t>, Block*> free_by_size;
+
+public:
+    void addFreeBlock(Block* block) override;
+    void removeFreeBlock(Block* block) override;
+    void clear() override;
+};
+
+class BestFit : public SizeOrderedAllocator {
 public:
-    Block* findFreeBlock(Block* head, size_t size) override;
+    Block* findFreeBlock(size_t size) override;
     std::string getName() const override;
 };
 
-class WorstFit : public Allocator {
+class WorstFit : public SizeOrderedAllocator {
+public:
+    Block* findFreeBlock(size_t size) override;
+    std::string getName() const override;
+};
+
+// Two-Level Segregated Fit: the first level splits sizes by power of 2, the second splits each
+// power-of-2 range into SL_COUNT equal sub-ranges. Each (fl, sl) pair has an intrusive LIFO list
+// (Block::free_next/free_prev) and two levels of bitmaps record the non-empty lists, so insert,
+// remove and search are a few bit operations: O(1) regardless of the number of free blocks.
+// Coalescing stays with MemoryManager, which merges a freed block with its free list neighbours
+// (the boundary tags of a real heap) before handing it back.
+class TLSF : public Allocator {
+private:
+    static constexpr int SL_LOG2 = 4;
+    static constexpr int SL_COUNT = 1 << SL_LOG2;
+    static constexpr int FL_COUNT = 64 - SL_LOG2 + 1;   // sizes below SL_COUNT share first level 0
+
+    uint64_t fl_bitmap;                 // bit fl set if any list of that first level is non-empty
+    uint32_t sl_bitmap[FL_COUNT];       // bit sl set if heads[fl][sl] is non-empty
+    Block* heads[FL_COUNT][SL_COUNT];
+
+    // list that holds blocks of exactly this size
+    static void mapping(size_t size, int& fl, int& sl);
+
 public:
-    Block* findFreeBlock(Block* head, size_t size) override;
+    TLSF();
+    /**
+     * Good fit: the request is rounded up to the next second-level boundary so that any block of
+     * the first non-empty list at or above it fits without a scan. If nothing is found there (the
+     * heap is nearly exhausted), only the head of the request's own list is tried, so a fitting
+     * block deeper in that list can be missed: the price of the O(1) bound.
+     */
+    Block* findFreeBlock(size_t size) override;
+    void addFreeBlock(Block* block) override;
+    void removeFreeBlock(Block* block) override;
+    void clear() override;
     std::string getName() const override;
 };
 
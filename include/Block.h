@@ -11,9 +11,15 @@ struct Block {
     bool is_free;           // status
     Block* next;            // pointer to next block in the list
     Block* prev;            // pointer to previous block
+    Block* free_next;       // links in a segregated free list (TLSF), only while free
+    Block* free_prev;
+
+    Block() : id(0), start_address(0), size(0), requested_size(0), is_free(true), next(nullptr), prev(nullptr),
+              free_next(nullptr), free_prev(nullptr) {}
 
     Block(int _id, size_t _start, size_t _size, bool _free = true)
-        : id(_id), start_address(_start), size(_size), requested_size(0), is_free(_free), next(nullptr), prev(nullptr) {}
+        : id(_id), start_address(_start), size(_size), requested_size(0), is_free(_free), next(nullptr), prev(nullptr),
+          free_next(nullptr), free_prev(nullptr) {}
 };
 
 #endif // BLOCK_H
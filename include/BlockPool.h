@@ -0,0 +1,63 @@
+#ifndef BLOCK_POOL_H
+#define BLOCK_POOL_H
+
+#include "Block.h"
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Arena for Block metadata nodes.
+ *
+ * Nodes are carved sequentially from fixed-size chunks, so list neighbours created
+ * together sit next to each other in memory, and recycled nodes go on an intrusive
+ * free list (threaded through Block::next). reset() rewinds the arena without
+ * touching individual nodes; chunks are kept for the next heap.
+ */
+class BlockPool {
+private:
+    static const size_t CHUNK_NODES = 4096;
+
+    std::vector<std::unique_ptr<Block[]>> chunks;
+    size_t current_chunk; // chunk being carved
+    size_t chunk_used;    // nodes handed out from current_chunk
+    Block* free_list;     // recycled nodes
+
+public:
+    BlockPool() : current_chunk(0), chunk_used(0), free_list(nullptr) {}
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    Block* create(int id, size_t start, size_t size, bool is_free) {
+        Block* node;
+        if (free_list) {
+            node = free_list;
+            free_list = free_list->next;
+        } else {
+            if (current_chunk == chunks.size() || chunk_used == CHUNK_NODES) {
+                if (current_chunk < chunks.size()) current_chunk++;
+                if (current_chunk == chunks.size()) {
+                    chunks.emplace_back(new Block[CHUNK_NODES]);
+                }
+                chunk_used = 0;
+            }
+            node = &chunks[current_chunk][chunk_used++];
+        }
+        *node = Block(id, start, size, is_free);
+        return node;
+    }
+
+    void destroy(Block* node) {
+        node->next = free_list;
+        free_list = node;
+    }
+
+    // O(1): every node handed out so far becomes invalid
+    void reset() {
+        current_chunk = 0;
+        chunk_used = 0;
+        free_list = nullptr;
+    }
+};
+
+#endif // BLOCK_POOL_H
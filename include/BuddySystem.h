@@ -0,0 +1,56 @@
+#ifndef BUDDY_SYSTEM_H
+#define BUDDY_SYSTEM_H
+
+#include "Block.h"
+#include <cstdint>
+#include <map>
+#include <vector>
+
+/**
+ * @brief Free-block index for the Buddy System.
+ *
+ * Keeps one address-ordered free list per order (block size 2^order) plus a
+ * bitmap per order whose bit i is set when the block at address i << order is
+ * free and unsplit. A block's buddy is found by XOR-ing its address with its size,
+ * so checking whether it can merge is a single bit test.
+ * The block list itself stays owned by MemoryManager, which does the split/merge
+ * surgery and keeps this index in sync.
+ */
+class BuddySystem {
+private:
+    static const int MAX_ORDERS = 64;
+
+    int max_order;                                   // log2 of the (rounded) heap size
+    std::map<size_t, Block*> free_lists[MAX_ORDERS]; // start_address -> free block, per order
+    uint64_t non_empty_orders;                       // bit k set if free_lists[k] has blocks
+    std::vector<std::vector<uint64_t>> free_map;     // free_map[k]: one bit per order-k block
+
+    bool testBit(int order, size_t address) const;
+    void setBit(int order, size_t address, bool value);
+
+public:
+    BuddySystem();
+
+    // sizes the bitmaps for a heap of total_size bytes and drops all free blocks
+    void reset(size_t total_size);
+
+    // true if the block is a power-of-2 size aligned to its size (can be indexed)
+    static bool isBuddyBlock(const Block* block);
+
+    void addFreeBlock(Block* block);
+    void removeFreeBlock(Block* block);
+
+    /**
+     * @brief Smallest free block of at least req_size (a power of 2), lowest address first.
+     * O(1) to find the order via the non-empty mask, O(log n) for the lowest address.
+     */
+    Block* findFreeBlock(size_t req_size) const;
+
+    /**
+     * @brief Returns the block's buddy if it is free and of the same order, nullptr otherwise.
+     * Buddies are adjacent in the address-ordered list, so it is block->prev or block->next.
+     */
+    Block* findFreeBuddy(Block* block) const;
+};
+
+#endif // BUDDY_SYSTEM_H
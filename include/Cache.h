@@ -1,27 +1,46 @@
 #ifndef CACHE_H
 #define CACHE_H
 
+#include "Prefetcher.h"
 #include <vector>
-#include <deque>
 #include <iostream>
+#include <memory>
 #include <string>
 
 enum class ReplacementPolicy {
     FIFO,
-    LRU
+    LRU,
+    OPT   // Belady: evict the line used furthest in the future (needs setNextUse hints)
 };
 
-struct CacheLine {
-    bool valid;
-    unsigned long long tag;
-    // for LRU or FIFO tracking, we can use a timestamp or just order in the deque
-    // Deque: Front is oldest (victim for FIFO/LRU if we move accessed items to back)
-    
-    CacheLine() : valid(false), tag(0) {} 
+enum class AccessType {
+    LOAD,
+    STORE,
+    IFETCH,
+    WRITEBACK, // dirty line evicted from the level above: a full block, allocated without a fetch
+    PREFETCH   // read issued by the prefetcher of the level above; does not train prefetchers
 };
 
-struct CacheSet {
-    std::deque<CacheLine> lines; // stores ways
+inline bool isDemandAccess(AccessType type) {
+    return type == AccessType::LOAD || type == AccessType::STORE || type == AccessType::IFETCH;
+}
+
+enum class WritePolicy {
+    WRITE_BACK,   // stores mark the line dirty; it is written below on eviction
+    WRITE_THROUGH // stores are forwarded below immediately; lines are never dirty
+};
+
+// What the last access asked of the next level down (memory for the last level)
+struct LowerRequests {
+    bool writeback;                        // a dirty victim was evicted
+    bool evicted;                          // a valid victim was evicted (only with eviction tracking)
+    bool fetch;                            // the block must be read from below
+    bool write;                            // a store is forwarded (write-through or no-write-allocate)
+    AccessType write_type;                 // STORE or WRITEBACK
+    unsigned long long victim_address;     // block address of the victim (writeback or evicted)
+
+    LowerRequests()
+        : writeback(false), evicted(false), fetch(false), write(false), write_type(AccessType::STORE), victim_address(0) {}
 };
 
 class CacheLevel {
@@ -31,20 +50,139 @@ private:
     size_t block_size;    // block size in bytes
     size_t associativity; // ways per set
     ReplacementPolicy policy;
+    WritePolicy write_policy;
+    bool write_allocate;  // store misses fill the line (otherwise they are only forwarded below)
 
     size_t num_sets;
     size_t num_lines;     // total lines
-    std::vector<CacheSet> sets;
+
+    // address decoding: shifts/masks when block size and set count are powers of 2,
+    // plain division otherwise
+    bool pow2_geometry;
+    unsigned block_shift;
+    unsigned set_shift;
+    unsigned long long set_mask;
+
+    // Flat structure-of-arrays storage: way w of set s lives at index s * associativity + w.
+    // An empty way holds INVALID_TAG (unreachable: tags always lose at least one address bit)
+    // and stamp 0, so it is both never matched and always picked first as the victim.
+    static constexpr unsigned long long INVALID_TAG = ~0ULL;
+    std::vector<unsigned long long> tags;
+    std::vector<unsigned long long> stamps; // FIFO: fill time, LRU: last access time, OPT: next use
+    unsigned long long clock;              // advances on every fill (and LRU hit)
+    std::vector<unsigned char> dirty;      // write-back only
+    size_t dirty_lines;                    // lets clean caches skip the dirty check on eviction
+    bool track_evictions;                  // report clean victims too (inclusive/exclusive hierarchies)
+    unsigned long long next_use;           // OPT only: position of the next reference to the accessed block
+    LowerRequests requests;                // outcome of the last access for the level below
+
+    // Prefetching (all untouched while no prefetcher is attached)
+    std::unique_ptr<Prefetcher> prefetcher;
+    std::vector<unsigned char> prefetched;               // line was prefetched and not yet used
+    size_t prefetched_lines;
+    std::vector<unsigned long long> pending_prefetches;  // candidates from the last demand access
+    // direct-mapped record of blocks displaced by prefetch fills; a demand miss on one is pollution
+    std::vector<unsigned long long> pollution_filter;
 
     // Stats
     size_t hits;
     size_t misses;
+    // traffic is derived from these (misses fetch a block, writebacks send one) to keep the hot path short
+    size_t writebacks;       // dirty evictions
+    size_t unfetched_misses; // misses that did not read from below (writeback fills, unallocated stores)
+    size_t forwarded_bytes;  // write-through / unallocated stores sent below
+    size_t prefetches_issued;  // blocks read from below for the prefetcher
+    size_t prefetches_useful;  // prefetched blocks later hit by a demand access
+    size_t prefetches_useless; // prefetched blocks evicted or invalidated unused
+    size_t pollution_misses;   // demand misses on blocks a prefetch fill had evicted
+    size_t uncovered_misses;   // demand misses while a prefetcher is attached
+
+    void decode(unsigned long long address, size_t& set_index, unsigned long long& tag) const;
+    unsigned long long blockAddress(size_t set_index, unsigned long long tag) const;
+    // way to replace in the set starting at base
+    size_t victimWay(size_t base) const;
+    // index of the resident line holding the block, num_lines if absent
+    size_t findLine(unsigned long long address) const;
+    // records the victim in line (writeback if dirty) before it is replaced
+    void evictLine(size_t line, size_t set_index);
+    // demand hit on line with a prefetcher attached
+    void prefetcherHit(size_t line, unsigned long long address, AccessType type);
+    // shows a demand access to the prefetcher and collects its candidates
+    void trainPrefetcher(unsigned long long address, bool hit, bool prefetched_hit);
+    size_t pollutionSlot(unsigned long long block_address) const;
+    // store into a resident line: dirty (write-back) or forwarded below (write-through)
+    void write(size_t line, AccessType type) {
+        if (write_policy == WritePolicy::WRITE_BACK) {
+            dirty_lines += !dirty[line];
+            dirty[line] = 1;
+            return;
+        }
+        requests.write = true;
+        requests.write_type = type;
+        forwarded_bytes += (type == AccessType::WRITEBACK) ? block_size : WORD_SIZE;
+    }
 
 public:
     CacheLevel(std::string name, size_t size, size_t block_size, size_t associativity, ReplacementPolicy policy);
 
-    // returns true on Hit, false on Miss
-    bool access(unsigned long long address);
+    // stores forwarded by write-through / no-write-allocate are counted as one word
+    static constexpr size_t WORD_SIZE = 8;
+
+    // returns true on Hit, false on Miss; lastRequests() then tells what the level below must do.
+    // A miss served from a stream buffer counts as a hit but returns false without a fetch request,
+    // so the displaced line is still handled like on a miss.
+    bool access(unsigned long long address, AccessType type = AccessType::LOAD);
+    const LowerRequests& lastRequests() const { return requests; }
+
+    // defaults: write-back, write-allocate
+    void setWritePolicy(WritePolicy policy, bool write_allocate);
+    // when set, every replaced valid line is reported through lastRequests().evicted
+    void setTrackEvictions(bool track) { track_evictions = track; }
+
+    // Inclusion support (no replacement-state or hit/miss side effects unless stated)
+    bool contains(unsigned long long address) const;
+    // drops the block if present; was_dirty tells whether its data still had to be written back
+    bool invalidate(unsigned long long address, bool& was_dirty);
+    // lookup that counts as a hit/miss and removes the block on a hit (exclusive lower levels);
+    // demand lookups also train the prefetcher
+    bool extract(unsigned long long address, bool& was_dirty, bool demand = true);
+    // places a block from the level above (victim fill) without counting an access;
+    // the displaced line is reported through lastRequests() like on a miss
+    void insert(unsigned long long address, bool is_dirty);
+    void markDirty(unsigned long long address);
+    // clears the dirty bit, keeping the line (coherence downgrade); true if the data had to be written back
+    bool clean(unsigned long long address);
+
+    // attaches a prefetcher (nullptr detaches); the candidates it produces on each demand access
+    // wait in pendingPrefetches() until the hierarchy issues them through prefetch()
+    void setPrefetcher(std::unique_ptr<Prefetcher> prefetcher);
+    const Prefetcher* getPrefetcher() const { return prefetcher.get(); }
+    std::vector<unsigned long long>& pendingPrefetches() { return pending_prefetches; }
+    // false if the block is already here; otherwise it is placed in the cache (or the prefetcher's
+    // buffer), lastRequests() asks for it to be fetched and reports the displaced line
+    bool prefetch(unsigned long long address);
+
+    // OPT only: trace position of the next reference to the block accessed next
+    // (NEVER_USED if there is none); must be set before every access()
+    static constexpr unsigned long long NEVER_USED = ~0ULL;
+    void setNextUse(unsigned long long position) { next_use = position; }
+
+    const std::string& getName() const { return name; }
+    size_t getSize() const { return size; }
+    size_t getBlockSize() const { return block_size; }
+    size_t getAssociativity() const { return associativity; }
+    ReplacementPolicy getPolicy() const { return policy; }
+    size_t getHits() const { return hits; }
+    size_t getMisses() const { return misses; }
+    WritePolicy getWritePolicy() const { return write_policy; }
+    bool isWriteAllocate() const { return write_allocate; }
+    size_t getWritebacks() const { return writebacks; }
+    size_t getPrefetchesIssued() const { return prefetches_issued; }
+    size_t getPrefetchesUseful() const { return prefetches_useful; }
+    size_t getPrefetchesUseless() const { return prefetches_useless + (prefetcher ? prefetcher->getDropped() : 0); }
+    size_t getPollutionMisses() const { return pollution_misses; }
+    size_t getBytesFromBelow() const { return (misses - unfetched_misses + prefetches_issued) * block_size; }
+    size_t getBytesToBelow() const { return writebacks * block_size + forwarded_bytes; }
 
     // getters for stats
     void printStats() const;
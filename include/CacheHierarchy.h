@@ -0,0 +1,109 @@
+#ifndef CACHE_HIERARCHY_H
+#define CACHE_HIERARCHY_H
+
+#include "Cache.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class InclusionPolicy {
+    NINE,      // non-inclusive non-exclusive: fills go to every level on the path, evictions are independent
+    INCLUSIVE, // every block above is also below; a lower-level eviction back-invalidates the levels above
+    EXCLUSIVE  // a block lives in one level only; lower levels are filled with the victims of the level above
+};
+
+/**
+ * @brief Any number of cache levels between the CPU (level 0) and main memory.
+ *
+ * Levels are added top-down, interactively (`cache add`) or from a config file:
+ *
+ *   level <size> <block_size> <assoc> [fifo|lru] [wb|wt] [wa|nwa]
+ *   prefetch <none|next_line|stride|stream> [degree] [distance]   (applies to the level above it)
+ *   inclusion <nine|inclusive|exclusive>
+ *
+ * Dirty victims, write-through stores and misses travel down level by level; whatever
+ * leaves the last level is counted as memory traffic. Prefetches collected by the levels' prefetchers
+ * during an access are issued once the demand access is complete, top level first.
+ */
+class CacheHierarchy {
+private:
+    std::vector<std::unique_ptr<CacheLevel>> levels;
+    InclusionPolicy inclusion;
+    bool prefetching;                               // some level has a prefetcher
+    std::vector<unsigned long long> prefetch_batch; // candidates being issued
+
+    // stats
+    size_t memory_reads;       // blocks fetched from memory
+    size_t memory_writes;      // writebacks and forwarded stores reaching memory
+    size_t back_invalidations; // inclusive: copies dropped above a lower-level eviction
+    std::vector<size_t> served_by; // demand accesses per serving level (last entry: memory)
+
+    // which levels must report clean victims for the current inclusion policy
+    void applyInclusion();
+
+    // NINE / inclusive: access starting at level first (first == size(): memory)
+    size_t accessFrom(size_t first, unsigned long long address, AccessType type);
+    // NINE / inclusive: victim reported by level i goes down (dirty) and out of the levels above (inclusive)
+    void handleVictim(size_t i, const LowerRequests& requests);
+    // inclusive: drops the block evicted from level in every level above; true if a copy was dirty
+    bool backInvalidate(size_t level, unsigned long long block_address);
+
+    size_t accessExclusive(unsigned long long address, AccessType type);
+    // exclusive: victim of the level above moves into level (memory past the last one)
+    void insertVictim(size_t level, unsigned long long address, bool dirty);
+    // exclusive: a store leaving the level above updates the lower copy if there is one, else memory
+    size_t writeExclusive(size_t first, unsigned long long address);
+
+    // fetches every level's pending prefetch candidates into it
+    void issuePrefetches();
+    void prefetchInto(size_t level, unsigned long long address);
+
+public:
+    CacheHierarchy();
+
+    CacheHierarchy(const CacheHierarchy&) = delete;
+    CacheHierarchy& operator=(const CacheHierarchy&) = delete;
+
+    // L1 (1KB, 64B, 2-way) and L2 (4KB, 64B, 4-way), FIFO, non-inclusive
+    void initDefault();
+    void clear();
+
+    // appends a level below the current last one; an empty name becomes "L<n> Cache"
+    // (rejected if its block size breaks the inclusion policy's rule, see setInclusion)
+    bool addLevel(size_t size, size_t block_size, size_t associativity, ReplacementPolicy policy,
+                  const std::string& name = "");
+    // exclusive hierarchies need one block size throughout, inclusive ones block sizes that never
+    // shrink toward memory; false (with a message) otherwise
+    bool setInclusion(InclusionPolicy policy);
+    // name: none, next_line, stride, stream; false (with a message) for unknown names or zero knobs
+    bool setPrefetcher(size_t level, const std::string& name, size_t degree = 1, size_t distance = 1);
+
+    // replaces the hierarchy with the one described in the file; false (unchanged) on errors
+    bool loadConfig(const std::string& path);
+
+    /**
+     * @brief Sends one access from the CPU through the hierarchy.
+     *
+     * @return size_t Index of the level that served it, numLevels() if it went to memory.
+     */
+    size_t access(unsigned long long address, AccessType type = AccessType::LOAD);
+
+    size_t numLevels() const { return levels.size(); }
+    CacheLevel& getLevel(size_t i) { return *levels[i]; }
+    const CacheLevel& getLevel(size_t i) const { return *levels[i]; }
+    InclusionPolicy getInclusion() const { return inclusion; }
+    size_t getMemoryReads() const { return memory_reads; }
+    size_t getMemoryWrites() const { return memory_writes; }
+    size_t getBackInvalidations() const { return back_invalidations; }
+    // demand accesses (load/store/ifetch) served by level i, i == numLevels(): by memory
+    size_t getServedBy(size_t i) const { return served_by[i]; }
+
+    void printStats() const;
+    void resetStats();
+};
+
+// "nine", "inclusive", "exclusive"; false for anything else
+bool parseInclusionPolicy(const std::string& name, InclusionPolicy& policy);
+const char* inclusionPolicyName(InclusionPolicy policy);
+
+#endif // CACHE_HIERARCHY_H
@@ -0,0 +1,142 @@
+#ifndef COMPACT_TRACE_H
+#define COMPACT_TRACE_H
+
+#include "Cache.h" // AccessType
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * Compact address trace (little-endian, version 1):
+ *
+ *   header  32 bytes: "MSCT", u32 version, u64 access count, u64 block count, u64 index offset
+ *   blocks  up to BLOCK_ACCESSES accesses each, encoded independently (decoding can start at any block)
+ *   index   per block: u64 file offset, u64 first access, u32 byte length, u32 access count
+ *
+ * Inside a block every access is a varint token; the previous address starts at 0:
+ *   low 2 bits 0..2   access type (load, store, ifetch); token >> 2 is the zigzag address delta
+ *   low 3 bits 011    absolute address follows as a varint; type = (token >> 3) & 3 (deltas over 2^62)
+ *   low 3 bits 111    run: repeat the previous delta and type (token >> 3) times
+ * Strided and sequential streams collapse into runs; random streams cost the varint of their deltas.
+ */
+class CompactTraceWriter {
+private:
+    FILE* file;
+    std::vector<unsigned char> block;
+    struct IndexEntry {
+        uint64_t offset;
+        uint64_t first_access;
+        uint32_t bytes;
+        uint32_t accesses;
+    };
+    std::vector<IndexEntry> index;
+    uint64_t total_accesses;
+    uint64_t file_offset;
+
+    // current block state
+    uint32_t block_accesses;
+    unsigned long long prev_address;
+    uint64_t last_delta;
+    AccessType last_type;
+    bool has_last;
+    uint64_t run;
+
+    void putVarint(uint64_t value);
+    void flushRun();
+    void flushBlock();
+
+public:
+    static constexpr uint32_t BLOCK_ACCESSES = 1 << 16;
+
+    CompactTraceWriter();
+    ~CompactTraceWriter();
+
+    CompactTraceWriter(const CompactTraceWriter&) = delete;
+    CompactTraceWriter& operator=(const CompactTraceWriter&) = delete;
+
+    // false (with a message) if path cannot be created
+    bool open(const std::string& path);
+    bool isOpen() const { return file != nullptr; }
+    void append(unsigned long long address, AccessType type);
+    // writes the last block, the index and the header; returns the file size in bytes
+    uint64_t close();
+    uint64_t getAccessCount() const { return total_accesses; }
+};
+
+/**
+ * @brief Zero-copy reader: the file is mapped read-only (mmap; read into memory on Windows)
+ * and blocks are decoded straight from the mapping into the caller's batch arrays.
+ */
+class CompactTraceReader {
+private:
+    const unsigned char* data;
+    size_t size;
+    std::vector<unsigned char> fallback; // _WIN32: file contents
+    uint64_t accesses;
+    uint64_t blocks;
+    const unsigned char* index;
+
+    // decode position
+    uint64_t next_block;
+    const unsigned char* pos;
+    const unsigned char* end;
+    uint32_t left_in_block;
+    unsigned long long prev_address;
+    uint64_t last_delta;
+    AccessType last_type;
+    uint64_t run;
+    bool corrupt;
+
+    void mapFile(const std::string& path);
+    void unmapFile();
+    bool enterBlock(uint64_t b);
+
+public:
+    explicit CompactTraceReader(const std::string& path);
+    ~CompactTraceReader();
+
+    CompactTraceReader(const CompactTraceReader&) = delete;
+    CompactTraceReader& operator=(const CompactTraceReader&) = delete;
+
+    // true if the file starts with the compact trace magic
+    static bool isCompactTrace(const std::string& path);
+
+    bool isOpen() const { return data != nullptr; }
+    uint64_t getAccessCount() const { return accesses; }
+    uint64_t getBlockCount() const { return blocks; }
+    size_t getFileSize() const { return size; }
+    bool isCorrupt() const { return corrupt; }
+
+    // positions the reader at access number n (block index lookup + partial decode)
+    bool seek(uint64_t n);
+    // decodes up to max accesses; types may be nullptr. 0 at end of trace
+    size_t readBatch(unsigned long long* out, AccessType* types, size_t max);
+};
+
+enum class TraceFormat {
+    AUTO,    // detect from the first address line
+    TEXT,    // the simulator's own "[type] <address>" lines
+    LACKEY,  // valgrind --tool=lackey --trace-mem=yes: "I  0400d7d4,8", " S 7ff000398,8"
+    PIN      // pinatrace: "0x7f5a2c3b1e: R 0x7ffd4c8a10"
+};
+
+bool parseTraceFormat(const std::string& name, TraceFormat& format);
+
+struct TraceConvertStats {
+    uint64_t lines;
+    uint64_t accesses;
+    uint64_t skipped;
+    uint64_t input_bytes;
+    uint64_t output_bytes;
+
+    TraceConvertStats() : lines(0), accesses(0), skipped(0), input_bytes(0), output_bytes(0) {}
+};
+
+/**
+ * @brief Converts a text trace (own format, Lackey or pinatrace) to the compact format.
+ * Lackey 'M' (modify) records become stores, like 'M' lines of the text format.
+ */
+bool convertTrace(const std::string& in_path, const std::string& out_path, TraceFormat format, TraceConvertStats& stats);
+
+#endif // COMPACT_TRACE_H
@@ -0,0 +1,134 @@
+#ifndef CONCURRENT_HEAP_H
+#define CONCURRENT_HEAP_H
+
+#include "MemoryManager.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct ConcurrentHeapConfig {
+    size_t max_cached_size;      // larger requests bypass the caches and go straight to the heap
+    size_t thread_cache_blocks;  // per size class and thread; beyond this a batch moves to the central list
+    size_t transfer_batch;       // blocks moved between a thread cache and a central list at once
+    size_t central_blocks;       // per size class; beyond this, blocks are freed back to the heap
+
+    ConcurrentHeapConfig() : max_cached_size(1024), thread_cache_blocks(64), transfer_batch(16), central_blocks(1024) {}
+};
+
+// Totals over the central lists and every flushed ThreadCache
+struct ConcurrentHeapStats {
+    size_t mallocs;
+    size_t frees;
+    size_t failures;            // heap out of memory
+    size_t thread_cache_hits;   // mallocs served without touching a lock
+    size_t central_hits;        // thread cache refills served by a central list
+    size_t heap_refills;        // central list empty: a batch was allocated from the heap
+    size_t large_allocs;        // above max_cached_size
+    size_t returned_to_heap;    // blocks a full central list gave back (heap can coalesce them)
+    size_t central_contention;  // central list lock acquisitions that had to wait
+    size_t invalid_frees;       // double frees caught by the id map
+
+    ConcurrentHeapStats()
+        : mallocs(0), frees(0), failures(0), thread_cache_hits(0), central_hits(0), heap_refills(0),
+          large_allocs(0), returned_to_heap(0), central_contention(0), invalid_frees(0) {}
+};
+
+class ThreadCache;
+
+/**
+ * @brief tcmalloc-style front end that lets many threads share one MemoryManager.
+ *
+ * Requests up to max_cached_size are rounded to a size class (16-byte steps to 128, then four
+ * classes per doubling). Each thread allocates through its own ThreadCache, which keeps freed
+ * blocks of every class and needs no lock on a hit. Misses and overflows move blocks in batches
+ * to/from a central free list per class, each behind its own mutex; only an empty central list
+ * reaches the heap, whose single lock is thus taken once per batch instead of once per call.
+ *
+ * Cached blocks stay allocated from the heap's point of view. Block ids handed out here must be
+ * freed through a ThreadCache, and the heap must not be re-initialized while the front end is in use.
+ */
+class ConcurrentHeap {
+private:
+    friend class ThreadCache;
+
+    static constexpr size_t GRANULE = 16;
+    static constexpr size_t MAP_CHUNK_BITS = 16;
+    static constexpr size_t MAP_CHUNKS = (size_t)1 << (31 - MAP_CHUNK_BITS); // block ids are positive ints
+    static constexpr uint8_t LIVE = 0x80; // id map: handed out to the program (not cached)
+
+    struct alignas(64) CentralList {
+        std::mutex mutex;
+        std::vector<int> blocks;
+    };
+
+    MemoryManager& heap;
+    ConcurrentHeapConfig config;
+    std::vector<size_t> class_sizes;
+    std::vector<uint8_t> class_of_granule; // ceil(size / GRANULE) -> class
+    std::unique_ptr<CentralList[]> central;
+
+    // block id -> (class + 1) | LIVE; 0 = not from a size class. Two-level radix map:
+    // readers never lock, chunks are allocated on first use under map_mutex
+    std::unique_ptr<std::atomic<std::atomic<uint8_t>*>[]> id_map;
+    std::mutex map_mutex;
+
+    // central counters; thread caches add theirs on flush
+    std::mutex stats_mutex;
+    ConcurrentHeapStats totals;
+    std::atomic<size_t> central_contention;
+    std::atomic<size_t> heap_refills;
+    std::atomic<size_t> returned_to_heap;
+
+    std::atomic<uint8_t>* mapEntry(int id, bool create);
+    std::unique_lock<std::mutex> lockCentral(size_t cls);
+    // moves up to transfer_batch blocks of class cls into out; 0 if the heap is exhausted
+    size_t fetch(size_t cls, std::vector<int>& out, bool& from_heap);
+    // takes ids[first..] into the central list of class cls
+    void release(size_t cls, std::vector<int>& ids, size_t first);
+    void mergeStats(const ConcurrentHeapStats& local);
+
+public:
+    explicit ConcurrentHeap(MemoryManager& heap, const ConcurrentHeapConfig& config = ConcurrentHeapConfig());
+    ~ConcurrentHeap();
+
+    ConcurrentHeap(const ConcurrentHeap&) = delete;
+    ConcurrentHeap& operator=(const ConcurrentHeap&) = delete;
+
+    size_t numClasses() const { return class_sizes.size(); }
+    size_t classSize(size_t cls) const { return class_sizes[cls]; }
+    // size class of a cacheable request (size <= max_cached_size)
+    size_t classOf(size_t size) const { return class_of_granule[(size + GRANULE - 1) / GRANULE]; }
+
+    MemoryManager& getHeap() { return heap; }
+    ConcurrentHeapStats getStats();
+    void printStats();
+};
+
+/**
+ * @brief Per-thread block cache; use one per thread (it is not itself thread-safe).
+ * malloc/free mirror MemoryManager::my_malloc/my_free. The destructor flushes every cached
+ * block to the central lists and adds the counters to the ConcurrentHeap totals.
+ */
+class ThreadCache {
+private:
+    ConcurrentHeap& owner;
+    std::vector<std::vector<int>> lists; // free block ids per size class
+    ConcurrentHeapStats local;
+
+public:
+    explicit ThreadCache(ConcurrentHeap& owner);
+    ~ThreadCache();
+
+    ThreadCache(const ThreadCache&) = delete;
+    ThreadCache& operator=(const ThreadCache&) = delete;
+
+    // returns a block id, or -1 if the heap is out of memory
+    int malloc(size_t size);
+    bool free(int block_id);
+    // returns all cached blocks to the central lists
+    void flush();
+};
+
+#endif // CONCURRENT_HEAP_H
@@ -3,27 +3,85 @@
 
 #include "Block.h"
 #include "Allocator.h"
+#include "BlockPool.h"
+#include "BuddySystem.h"
+#include "SlabAllocator.h"
+#include <atomic>
 #include <iostream>
 #include <vector>
 #include <memory> 
+#include <mutex>
+#include <unordered_map>
 
+// Snapshot of the block list and allocation counters
+struct HeapStats {
+    size_t total_memory;
+    size_t used_memory;
+    size_t requested_memory;
+    size_t free_memory;
+    size_t free_blocks;
+    size_t largest_free_block;
+    size_t alloc_attempts;
+    size_t alloc_failures;
+
+    size_t internalFragmentation() const { return used_memory - requested_memory; }
+    // share of the free memory outside the largest free block, 0..1
+    double externalFragmentation() const {
+        return free_memory ? (double)(free_memory - largest_free_block) / free_memory : 0.0;
+    }
+};
+
+/**
+ * @brief Simulated heap: address-ordered block list plus the active strategy's free index.
+ *
+ * init, setAllocator, my_malloc, my_free, dumpMemory and getHeapStats take one heap-wide
+ * lock, so any number of threads may allocate and free concurrently (see ConcurrentHeap for
+ * per-thread caches in front of it). getHead() exposes the list without locking.
+ */
 class MemoryManager {
 private:
     size_t total_memory_size;
     Block* memory_head; // head of the linked list of blocks
+    BlockPool block_pool; // owns every Block node; reset in bulk on init
     std::unique_ptr<Allocator> allocator; // current strategy
     int next_block_id; // auto-incrementing ID for allocations
+    std::unordered_map<int, Block*> block_index; // ID -> allocated block, for O(1) free
     bool is_buddy_mode; // flag for Buddy System
+    bool verbose; // per-operation console messages (off for benchmarks and batch replay)
+    BuddySystem buddy_system; // per-order free lists used in buddy mode
+    bool is_slab_mode; // small requests go to slab caches carved from the heap
+    SlabAllocator slab_allocator; // slabs stay valid across mode switches until freed
 
     // stats counters
     size_t alloc_attempts;
     size_t alloc_failures;
 
-    // helper to merge adjacent free blocks
-    void coalesce();
+    // guards the block list, the free-block index, block_index, next_block_id and the counters
+    mutable std::mutex heap_mutex;
+    mutable std::atomic<size_t> lock_contention; // acquisitions that found the heap locked
+
+    std::unique_lock<std::mutex> lockHeap() const;
+    // my_malloc / my_free bodies; the caller holds heap_mutex
+    int mallocLocked(size_t size);
+    bool freeLocked(int block_id);
+
+    // helper to merge a newly freed block with its free neighbours
+    void coalesce(Block* block);
+    // unlinks block->next and folds its size into block
+    void absorbNext(Block* block);
+    // re-seeds the strategy's (or buddy system's) free-block index from the block list
+    void rebuildFreeIndex();
+    // splits block at 'size' and returns the new free remainder linked after it
+    Block* splitBlock(Block* block, size_t size);
     // buddy specific helpers
-    void coalesceBuddy();
-    Block* findBuddy(Block* block);
+    void mergeBuddies(Block* block);
+    void releaseBuddyBlock(Block* block);
+    // first/best/worst fit: takes a free block of at least size, split to size; nullptr if none
+    Block* takeFreeBlock(size_t size);
+    // returns a used block to the free structures of the current mode
+    void releaseBlock(Block* block);
+    // slab mode allocation of size <= SlabAllocator::MAX_OBJECT_SIZE; -1 (nothing counted) if no slab fits
+    int slabMalloc(size_t size);
 
 public:
     MemoryManager();
@@ -39,14 +97,29 @@ public:
     // returns ID of the allocated block, or -1 on failure
     int my_malloc(size_t size);
 
+    // up to count blocks of size under one lock acquisition, appended to out; stops at the first failure
+    size_t mallocBatch(size_t size, size_t count, std::vector<int>& out);
+
     // deallocation
     bool my_free(int block_id);
+    // frees every id under one lock acquisition; returns how many were freed
+    size_t freeBatch(const std::vector<int>& ids);
+
+    // verbose = false silences the per-malloc/free messages (including allocation failures)
+    // and the init/setAllocator confirmations; warnings and errors are still printed
+    void setVerbose(bool v) { verbose = v; }
+    bool isVerbose() const { return verbose; }
 
     // Debugging / Vis
     void dumpMemory() const;
+    // in slab mode (or while slab objects are live) also prints per-class slab utilization
     void printStats() const;
+    // walks the block list; O(number of blocks)
+    HeapStats getHeapStats() const;
+    // number of times a thread had to wait for the heap lock
+    size_t getLockContention() const { return lock_contention.load(std::memory_order_relaxed); }
     
-    // getters for integration
+    // getters for integration (single-threaded use only)
     Block* getHead() const { return memory_head; }
 };
 
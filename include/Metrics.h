@@ -0,0 +1,96 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "CacheHierarchy.h"
+#include "MemoryManager.h"
+#include "PageTable.h"
+#include "TimingModel.h"
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Flat, ordered list of named counters for machine-readable export.
+ *
+ * Names are dotted paths ("cache.l1.hits", "vm.tlb.l2.misses"); values are kept as
+ * formatted text so counters stay exact integers.
+ */
+class MetricSet {
+private:
+    std::vector<std::pair<std::string, std::string>> values;
+
+public:
+    void add(const std::string& name, unsigned long long value);
+    void add(const std::string& name, double value);
+    void add(const std::string& name, const std::string& value); // exported as a string
+
+    size_t size() const { return values.size(); }
+
+    // one flat JSON object: {"name": value, ...}
+    void writeJSON(std::ostream& out) const;
+    // "metric,value" rows with a header
+    void writeCSV(std::ostream& out) const;
+};
+
+// every counter of each component, under "heap.", "cache." and "vm."
+void collectMetrics(const MemoryManager& heap, MetricSet& out);
+void collectMetrics(const CacheHierarchy& caches, MetricSet& out);
+void collectMetrics(const VirtualMemoryManager& vm, MetricSet& out);
+// total cycles and AMAT under "timing."; vm may be nullptr
+void collectMetrics(const TimingModel& timing, const CacheHierarchy& caches, const VirtualMemoryManager* vm, MetricSet& out);
+
+/**
+ * @brief Writes one CSV row every N events (accesses, allocations or frees).
+ *
+ * Columns: events, the hit rate of each cache level, the page fault rate, external
+ * fragmentation and the number of free heap blocks. Rates cover only the accesses of the
+ * last interval so phases show up; fragmentation and free blocks are the current state.
+ * A source that is absent (nullptr) or has no accesses in the interval leaves its field empty.
+ * The sources are passed to every call since the simulator may replace them (e.g. vm init).
+ */
+class IntervalSampler {
+private:
+    std::ofstream out;
+    size_t interval;
+    size_t num_levels;          // cache columns, fixed when the file is opened
+    unsigned long long events;
+    unsigned long long next_sample;
+
+    // cumulative counters at the previous sample
+    std::vector<size_t> last_hits;
+    std::vector<size_t> last_misses;
+    size_t last_faults;
+    size_t last_translations;
+
+    void writeRow(const CacheHierarchy* caches, const VirtualMemoryManager* vm, const MemoryManager* heap);
+
+public:
+    IntervalSampler();
+    ~IntervalSampler();
+
+    /**
+     * @brief Starts sampling into path (truncated), every interval events.
+     * The current counters of caches and vm (may be nullptr) are the baseline of the first row.
+     * @return false if interval is 0 or the file cannot be created
+     */
+    bool open(const std::string& path, size_t interval, const CacheHierarchy& caches, const VirtualMemoryManager* vm);
+    // writes the last partial interval, if any, and closes the file
+    void close(const CacheHierarchy* caches, const VirtualMemoryManager* vm, const MemoryManager* heap);
+    bool isOpen() const { return out.is_open(); }
+
+    // events left before the next row is due
+    unsigned long long untilNextSample() const { return next_sample - events; }
+
+    // count n events; writes a row when an interval boundary is reached
+    void advance(size_t n, const CacheHierarchy* caches, const VirtualMemoryManager* vm, const MemoryManager* heap) {
+        events += n;
+        if (events >= next_sample) writeRow(caches, vm, heap);
+    }
+};
+
+// writes the metrics as JSON or CSV (by format name) to path, or to stdout when path is empty or "-"
+bool exportMetrics(const MetricSet& metrics, const std::string& format, const std::string& path);
+
+#endif // METRICS_H
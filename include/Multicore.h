@@ -0,0 +1,114 @@
+#ifndef MULTICORE_H
+#define MULTICORE_H
+
+#include "CacheHierarchy.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class CoherenceMiss {
+    NONE,          // hit, or a miss unrelated to coherence (cold / capacity / conflict)
+    TRUE_SHARING,  // the copy was invalidated and the accessed word was written by another core since
+    FALSE_SHARING  // the copy was invalidated, but only other words of the line were written since
+};
+
+// What one multicore access did, for the interactive command
+struct CoherenceResult {
+    size_t served;          // 0: own L1, 1..: shared level, 1 + shared levels: memory
+    uint64_t invalidated;   // cores whose copies were invalidated
+    int downgraded;         // core whose M/E copy became shared, -1 if none
+    bool flushed;           // the downgraded or invalidated copy was dirty and written back
+    CoherenceMiss miss;
+};
+
+struct CoherenceStats {
+    size_t accesses;
+    size_t invalidations;  // copies invalidated by other cores' stores
+    size_t upgrades;       // S -> M (store hit on a shared line)
+    size_t downgrades;     // M/E -> S (another core read the line)
+    size_t flushes;        // dirty copies written back because of a downgrade or invalidation
+    size_t true_sharing_misses;
+    size_t false_sharing_misses;
+
+    CoherenceStats()
+        : accesses(0), invalidations(0), upgrades(0), downgrades(0), flushes(0),
+          true_sharing_misses(0), false_sharing_misses(0) {}
+};
+
+/**
+ * @brief Cores with private write-back L1s over shared lower levels, kept coherent by MESI.
+ *
+ * A full-map directory (one presence bit per core, plus whether the single holder may be
+ * dirty) stands in for snooping: it reaches the same states with the same invalidations.
+ * Per L1 line the MESI state is implied: not present = I; present with other sharers = S;
+ * sole holder = E, or M once it stored (the L1 dirty bit).
+ *
+ * Coherence misses are classified as in Dubois et al.: when a core loses its copy to another
+ * core's store, the words written afterwards are recorded; re-missing on one of those words
+ * is true sharing, on any other word false sharing. Lines with coherence traffic are kept
+ * for the false-sharing hotspot report.
+ */
+class MulticoreSystem {
+private:
+    struct DirEntry {
+        uint64_t sharers;   // cores holding the line
+        uint64_t lost;      // cores whose copy was invalidated and that have not missed on it since
+        bool exclusive;     // single sharer in E or M
+    };
+
+    struct LineReport {
+        size_t invalidations;
+        size_t true_sharing;
+        size_t false_sharing;
+        std::vector<uint64_t> words_written; // per core, bit w = word w of the line
+        std::vector<uint64_t> words_read;
+    };
+
+    size_t num_cores;
+    size_t block_size;
+    std::vector<std::unique_ptr<CacheLevel>> l1s;
+    CacheHierarchy shared;
+    std::unordered_map<unsigned long long, DirEntry> directory;
+    // per block: for each core in DirEntry::lost, the words written by others since it lost the line
+    std::unordered_map<unsigned long long, std::vector<uint64_t>> written_since_loss;
+    std::unordered_map<unsigned long long, LineReport> lines;
+    CoherenceStats stats;
+
+    LineReport& report(unsigned long long block);
+    void invalidateCopy(size_t core, unsigned long long block, DirEntry& entry, CoherenceResult& result);
+    // the L1 of core dropped victim
+    void evicted(size_t core, unsigned long long victim, bool dirty);
+
+public:
+    static const size_t MAX_CORES = 64;
+
+    MulticoreSystem();
+
+    MulticoreSystem(const MulticoreSystem&) = delete;
+    MulticoreSystem& operator=(const MulticoreSystem&) = delete;
+
+    // private L1s (write-back, LRU) and one shared L2; false (with a message) on bad parameters
+    bool init(size_t cores, size_t block_size, size_t l1_size, size_t l1_assoc, size_t l2_size, size_t l2_assoc);
+    bool isInitialized() const { return num_cores > 0; }
+    size_t getNumCores() const { return num_cores; }
+    size_t getNumSharedLevels() const { return shared.numLevels(); }
+
+    CoherenceResult access(size_t core, unsigned long long address, AccessType type);
+
+    /**
+     * @brief Replays core-tagged traces.
+     *
+     * One path: every line is "<core> [type] <address>". Several paths: file i is core i's own
+     * trace, and the cores take turns one access at a time until every file is exhausted.
+     */
+    bool run(const std::vector<std::string>& paths);
+
+    const CoherenceStats& getStats() const { return stats; }
+    void printStats() const;
+    // lines with the most false-sharing misses, with the words each core wrote and read
+    void printSharingReport(size_t top) const;
+};
+
+#endif // MULTICORE_H
@@ -0,0 +1,67 @@
+#ifndef OPTIMAL_ANALYZER_H
+#define OPTIMAL_ANALYZER_H
+
+#include "Cache.h"
+#include "PageTable.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Next-use index of an address trace, built in bounded memory.
+ *
+ * The text trace is decoded once into a binary temp file, which is then scanned
+ * backwards in fixed-size chunks. For every reference and every requested
+ * granularity (block/page shift) the position of the next reference to the same
+ * block is written to its own temp file. Memory use is a few chunk buffers plus
+ * one hash entry per distinct block; the trace itself never has to fit in RAM.
+ */
+class NextUseIndex {
+private:
+    FILE* addresses;              // binary copy of the trace
+    std::vector<FILE*> next_uses; // one stream per shift
+    std::vector<unsigned> shifts;
+    size_t length;
+
+    void close();
+
+public:
+    static constexpr size_t CHUNK = 1 << 20;
+
+    NextUseIndex();
+    ~NextUseIndex();
+
+    NextUseIndex(const NextUseIndex&) = delete;
+    NextUseIndex& operator=(const NextUseIndex&) = delete;
+
+    // decodes the trace and computes next-use positions for each shift; false on I/O failure
+    bool build(const std::string& trace_path, const std::vector<unsigned>& shifts);
+
+    size_t size() const { return length; }
+    size_t numStreams() const { return shifts.size(); }
+
+    // positional reads of [start, start + count)
+    void readAddresses(size_t start, size_t count, unsigned long long* out) const;
+    void readNextUses(size_t stream, size_t start, size_t count, unsigned long long* out) const;
+};
+
+/**
+ * @brief Compares the configured cache levels and page replacement policy with Belady's OPT.
+ *
+ * Each cache level is analysed on its own against the full trace (addresses taken as
+ * physical), and the VM on the virtual page stream: the configured policy and an OPT
+ * twin with identical geometry are run side by side and their misses/faults reported.
+ */
+class OptimalAnalyzer {
+private:
+    std::vector<const CacheLevel*> caches;
+    const VirtualMemoryManager* vm; // nullptr: skip the paging analysis
+
+public:
+    OptimalAnalyzer(const std::vector<const CacheLevel*>& caches, const VirtualMemoryManager* vm);
+
+    // streams the trace twice (index build + simulation) and prints the comparison
+    bool run(const std::string& trace_path);
+};
+
+#endif // OPTIMAL_ANALYZER_H
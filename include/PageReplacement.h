@@ -0,0 +1,43 @@
+#ifndef PAGE_REPLACEMENT_H
+#define PAGE_REPLACEMENT_H
+
+#include <string>
+#include <vector>
+
+struct PageTableEntry;
+
+// abstract Base Class for Page Replacement Policies
+// Policies work on physical frame numbers. VirtualMemoryManager reports every load and
+// every reference, and asks for a victim only when no frame is free.
+class PageReplacementPolicy {
+public:
+    virtual ~PageReplacementPolicy() = default;
+
+    /**
+     * @brief Sizes the policy for num_frames frames, all empty.
+     *
+     * @param frame_ptes frame_ptes[f] is the PTE of the page resident in frame f. Policies that
+     *        model hardware bits (Clock, Second-Chance) read and clear referenced/dirty there.
+     */
+    virtual void init(size_t num_frames, const std::vector<PageTableEntry*>* frame_ptes) = 0;
+
+    // page vpn was loaded into frame after a fault
+    virtual void onLoad(int frame, unsigned long long vpn) = 0;
+
+    // the page in frame was referenced (TLB or page-table hit)
+    virtual void onAccess(int frame) = 0;
+
+    /**
+     * @brief Chooses the frame to evict for incoming_vpn and drops it from the policy's bookkeeping.
+     * Only called when every frame is occupied.
+     */
+    virtual int selectVictim(unsigned long long incoming_vpn) = 0;
+
+    // future knowledge for offline policies: trace position of the next reference to the
+    // page accessed next. Online policies ignore it.
+    virtual void setNextUse(unsigned long long) {}
+
+    virtual std::string getName() const = 0;
+};
+
+#endif // PAGE_REPLACEMENT_H
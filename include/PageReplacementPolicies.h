@@ -0,0 +1,163 @@
+#ifndef PAGE_REPLACEMENT_POLICIES_H
+#define PAGE_REPLACEMENT_POLICIES_H
+
+#include "PageReplacement.h"
+#include <list>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+// Intrusive doubly linked list over frame numbers: O(1) push, remove and move-to-back.
+// Front is the oldest / least recently used frame.
+class FrameList {
+private:
+    std::vector<int> prev_frame;
+    std::vector<int> next_frame;
+    std::vector<char> linked;
+    int head;
+    int tail;
+    size_t count;
+
+public:
+    FrameList() : head(-1), tail(-1), count(0) {}
+
+    void init(size_t num_frames);
+    void pushBack(int frame);
+    void remove(int frame);
+    void moveToBack(int frame);
+
+    int front() const { return head; }
+    bool contains(int frame) const { return linked[frame] != 0; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+};
+
+// History of recently evicted VPNs (no frame attached), for 2Q and ARC. Front is the oldest.
+class GhostList {
+private:
+    std::list<unsigned long long> order;
+    std::unordered_map<unsigned long long, std::list<unsigned long long>::iterator> position;
+
+public:
+    bool contains(unsigned long long vpn) const { return position.count(vpn) != 0; }
+    void pushBack(unsigned long long vpn);
+    void remove(unsigned long long vpn);
+    void popFront();
+    size_t size() const { return order.size(); }
+    void clear();
+};
+
+class FIFOPolicy : public PageReplacementPolicy {
+private:
+    FrameList queue; // load order
+
+public:
+    void init(size_t num_frames, const std::vector<PageTableEntry*>* frame_ptes) override;
+    void onLoad(int frame, unsigned long long vpn) override;
+    void onAccess(int frame) override;
+    int selectVictim(unsigned long long incoming_vpn) override;
+    std::string getName() const override;
+};
+
+class LRUPolicy : public PageReplacementPolicy {
+private:
+    FrameList recency; // front = least recently used
+
+public:
+    void init(size_t num_frames, const std::vector<PageTableEntry*>* frame_ptes) override;
+    void onLoad(int frame, unsigned long long vpn) override;
+    void onAccess(int frame) override;
+    int selectVictim(unsigned long long incoming_vpn) override;
+    std::string getName() const override;
+};
+
+// Clock: the hand sweeps frames, clearing reference bits, and evicts the first unreferenced page.
+class ClockPolicy : public PageReplacementPolicy {
+protected:
+    const std::vector<PageTableEntry*>* ptes;
+    size_t num_frames;
+    size_t hand;
+
+public:
+    ClockPolicy() : ptes(nullptr), num_frames(0), hand(0) {}
+    void init(size_t num_frames, const std::vector<PageTableEntry*>* frame_ptes) override;
+    void onLoad(int frame, unsigned long long vpn) override;
+    void onAccess(int frame) override;
+    int selectVictim(unsigned long long incoming_vpn) override;
+    std::string getName() const override;
+};
+
+// Enhanced Second-Chance: classes by (referenced, dirty); prefers (0,0), then (0,1),
+// clearing reference bits on the second sweep, and repeats.
+class SecondChancePolicy : public ClockPolicy {
+public:
+    int selectVictim(unsigned long long incoming_vpn) override;
+    std::string getName() const override;
+};
+
+// 2Q (Johnson & Shasha): new pages enter the FIFO A1in; pages re-referenced after leaving
+// A1in (remembered in the ghost queue A1out) are promoted to the LRU queue Am.
+class TwoQueuePolicy : public PageReplacementPolicy {
+private:
+    FrameList a1_in;
+    FrameList am;
+    GhostList a1_out;
+    std::vector<unsigned long long> frame_vpn;
+    size_t k_in;  // target size of A1in (25% of frames)
+    size_t k_out; // capacity of A1out (50% of frames)
+
+public:
+    TwoQueuePolicy() : k_in(1), k_out(1) {}
+    void init(size_t num_frames, const std::vector<PageTableEntry*>* frame_ptes) override;
+    void onLoad(int frame, unsigned long long vpn) override;
+    void onAccess(int frame) override;
+    int selectVictim(unsigned long long incoming_vpn) override;
+    std::string getName() const override;
+};
+
+// ARC (Megiddo & Modha): recency list T1 and frequency list T2 with ghost lists B1/B2;
+// the target size p of T1 adapts on ghost hits.
+class ARCPolicy : public PageReplacementPolicy {
+private:
+    FrameList t1;
+    FrameList t2;
+    GhostList b1;
+    GhostList b2;
+    std::vector<unsigned long long> frame_vpn;
+    size_t capacity;
+    size_t p;
+    bool load_to_t2; // set by selectVictim when the incoming page was a ghost hit
+
+    int evictFrom(FrameList& list, GhostList* ghost);
+    int replace(bool incoming_in_b2);
+
+public:
+    ARCPolicy() : capacity(0), p(0), load_to_t2(false) {}
+    void init(size_t num_frames, const std::vector<PageTableEntry*>* frame_ptes) override;
+    void onLoad(int frame, unsigned long long vpn) override;
+    void onAccess(int frame) override;
+    int selectVictim(unsigned long long incoming_vpn) override;
+    std::string getName() const override;
+};
+
+// Belady's OPT (offline): evicts the page whose next reference is furthest in the future.
+// Depends on setNextUse() before every reference, so it is driven by OptimalAnalyzer only.
+class OptimalPolicy : public PageReplacementPolicy {
+private:
+    std::vector<unsigned long long> frame_next_use;
+    std::set<std::pair<unsigned long long, int>> by_next_use; // (next use, frame)
+    unsigned long long next_use;
+
+    void update(int frame);
+
+public:
+    OptimalPolicy() : next_use(~0ULL) {}
+    void init(size_t num_frames, const std::vector<PageTableEntry*>* frame_ptes) override;
+    void onLoad(int frame, unsigned long long vpn) override;
+    void onAccess(int frame) override;
+    int selectVictim(unsigned long long incoming_vpn) override;
+    void setNextUse(unsigned long long position) override { next_use = position; }
+    std::string getName() const override;
+};
+
+#endif // PAGE_REPLACEMENT_POLICIES_H
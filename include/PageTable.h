@@ -1,60 +1,137 @@
 #ifndef PAGE_TABLE_H
 #define PAGE_TABLE_H
 
+#include "PageReplacement.h"
+#include "TLB.h"
 #include <vector>
-#include <unordered_map>
 #include <list>
+#include <memory>
 #include <iostream>
 #include <iomanip>
+#include <string>
 
 struct PageTableEntry {
     bool valid;
+    bool referenced; // set on every access, cleared by Clock-style replacement sweeps
+    bool dirty;      // page modified since it was loaded
     int frame_number;
-    // TODO: add bits for dirty, read/write
-    PageTableEntry() : valid(false), frame_number(-1) {}
+    PageTableEntry() : valid(false), referenced(false), dirty(false), frame_number(-1) {}
+};
+
+// One node of the radix page table: inner levels hold child pointers, the last level holds PTEs.
+// Nodes are allocated lazily, only for regions of the address space that have been touched.
+struct PageTableNode {
+    std::vector<std::unique_ptr<PageTableNode>> children;
+    std::vector<PageTableEntry> entries;
 };
 
 class VirtualMemoryManager {
 private:
     size_t page_size;
+    unsigned page_shift;
     size_t physical_memory_size; // To know max frames
     size_t num_frames;
     
-    // Page Table: Map VPN -> PTE
-    // using a map to simulate a sparse or per-process page table
-    std::unordered_map<int, PageTableEntry> page_table;
+    // Page Table: multi-level radix tree indexed by the full 64-bit VPN (x86-64 style).
+    // Level 0 is the root; each level consumes bits_per_level bits of the VPN, except the
+    // root, which takes whatever high bits remain.
+    int levels;
+    unsigned bits_per_level;
+    std::unique_ptr<PageTableNode> root;
+    size_t table_nodes;
+
+    // translation cache in front of the page walk (nullptr = disabled)
+    std::unique_ptr<TLB> tlb;
 
     // Physical Memory Tracking (Frame Allocation)
     // for simplicity, we track which physical frames are free/used
-    // frame_allocation[i] = -1 if free, else contains VPN of owner (for reverse lookup during eviction)
-    std::vector<int> frame_table; 
+    // frame_table[i] = NO_VPN if free, else contains VPN of owner (for reverse lookup during eviction)
+    static constexpr unsigned long long NO_VPN = ~0ULL;
+    std::vector<unsigned long long> frame_table; 
+    std::vector<PageTableEntry*> frame_ptes; // PTE of the resident page per frame (nullptr if free)
     std::list<int> free_frames;
 
-    // Page Replacement: FIFO Queue of used frames
-    // stores VPNs in order of loading
-    std::list<int> present_pages_fifo; 
+    // Page Replacement: current policy (FIFO by default)
+    std::unique_ptr<PageReplacementPolicy> replacement;
+    std::string replacement_type; // name passed to setReplacementPolicy
 
     // stats
     size_t page_faults;
     size_t page_hits;
+    size_t disk_writes; // dirty victims saved on eviction
+    std::vector<size_t> walk_refs; // page-walk memory references per level
+
+    bool verbose; // per-fault console messages (off for batch replay)
 
 public:
-    VirtualMemoryManager(size_t phys_size, size_t pg_size);
+    /**
+     * @param levels Number of page-table levels; 0 picks enough 9-bit levels to cover the 64-bit VPN.
+     */
+    // verbose = false also silences the initialization message (analysis/sweep copies)
+    VirtualMemoryManager(size_t phys_size, size_t pg_size, int levels = 0, bool verbose = true);
+
+    /**
+     * @brief Whether `levels` splits the VPN of `pg_size` pages so every level, the root
+     * included, indexes at least one bit. 0 (automatic) always fits.
+     */
+    static bool levelsFit(size_t pg_size, int levels);
 
     /**
      * @brief Translates Virtual Address to Physical Address.
      * Handles Page Faults if page is not in memory.
      * 
      * @param v_addr Virtual Address
+     * @param is_write Store access: marks the page dirty
      * @return long long Physical Address
      */
-    unsigned long long translate(unsigned long long v_addr);
+    unsigned long long translate(unsigned long long v_addr, bool is_write = false);
 
     void printStats() const;
     void printPageTable() const;
 
+    /**
+     * @brief Replaces the TLB (default: 64-entry 4-way L1 dTLB, 1024-entry 8-way L2 STLB, LRU).
+     * Passing l1_entries == 0 disables it so every translation walks the page table.
+     */
+    void configureTLB(size_t l1_entries, size_t l1_assoc, size_t l2_entries, size_t l2_assoc, ReplacementPolicy policy);
+
+    // set the page replacement policy (fifo, lru, clock, second_chance, 2q, arc)
+    void setReplacementPolicy(const std::string& type);
+    // installs a policy object directly (e.g. the offline OptimalPolicy)
+    void setReplacementPolicy(std::unique_ptr<PageReplacementPolicy> policy, const std::string& type);
+    // forwards future knowledge to offline policies; see PageReplacementPolicy::setNextUse
+    void setNextUse(unsigned long long position) { replacement->setNextUse(position); }
+
+    size_t getPhysicalMemorySize() const { return physical_memory_size; }
+    size_t getPageSize() const { return page_size; }
+    int getLevels() const { return levels; }
+    const std::string& getReplacementPolicyType() const { return replacement_type; }
+    size_t getPageFaults() const { return page_faults; }
+    size_t getPageHits() const { return page_hits; }
+    size_t getDiskWrites() const { return disk_writes; }
+    size_t getWalkReferences() const;
+    const TLB* getTLB() const { return tlb.get(); }
+
+    void setVerbose(bool v) { verbose = v; }
+    bool isVerbose() const { return verbose; }
+
 private:
-    void handlePageFault(int vpn);
+    unsigned indexAt(unsigned long long vpn, int level) const;
+    // hardware walk: counts one memory reference per level visited; nullptr if the path is not mapped
+    PageTableEntry* walk(unsigned long long vpn);
+    // OS-side lookup (not counted as a walk); allocates missing nodes when create is set
+    PageTableEntry* findEntry(unsigned long long vpn, bool create);
+    PageTableNode* newNode(int level);
+    void printNode(const PageTableNode* node, int level, unsigned long long vpn_prefix) const;
+
+    // marks the resident page in frame as referenced (and dirty on writes) and informs the policy
+    void touchFrame(int frame, bool is_write) {
+        frame_ptes[frame]->referenced = true;
+        if (is_write) frame_ptes[frame]->dirty = true;
+        replacement->onAccess(frame);
+    }
+
+    void handlePageFault(unsigned long long vpn);
 };
 
 #endif // PAGE_TABLE_H
@@ -0,0 +1,111 @@
+#ifndef PREFETCHER_H
+#define PREFETCHER_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// abstract Base Class for hardware prefetchers attached to a CacheLevel
+// The level reports every demand access (loads, stores, instruction fetches) by block address;
+// the prefetcher answers with the block addresses it wants fetched. The level drops candidates
+// it already holds and the hierarchy reads the rest from below.
+class Prefetcher {
+protected:
+    size_t block_size;
+    size_t degree;   // blocks requested per trigger
+    size_t distance; // how far ahead of the trigger the first block is (in blocks or strides)
+
+public:
+    Prefetcher(size_t _block_size, size_t _degree, size_t _distance)
+        : block_size(_block_size), degree(_degree), distance(_distance) {}
+    virtual ~Prefetcher() = default;
+
+    /**
+     * @brief Observes one demand access and appends the blocks to prefetch.
+     *
+     * @param hit The block was found (in the cache or, for stream buffers, in the buffer).
+     * @param prefetched_hit The hit consumed a prefetched block for the first time.
+     */
+    virtual void onAccess(unsigned long long block_address, bool hit, bool prefetched_hit,
+                          std::vector<unsigned long long>& prefetches) = 0;
+
+    // false: prefetched blocks wait in the prefetcher's own buffers instead of the cache
+    virtual bool fillsCache() const { return true; }
+    // buffered prefetchers only: removes the block from the buffers if it is there
+    virtual bool takeBuffered(unsigned long long) { return false; }
+    // buffered prefetchers only: blocks discarded from the buffers without being used
+    virtual size_t getDropped() const { return 0; }
+    virtual void resetStats() {}
+
+    virtual std::string getName() const = 0;
+    size_t getDegree() const { return degree; }
+    size_t getDistance() const { return distance; }
+};
+
+// Next-line (tagged): on a miss or the first hit to a prefetched block, fetch blocks
+// distance .. distance + degree - 1 after it
+class NextLinePrefetcher : public Prefetcher {
+public:
+    NextLinePrefetcher(size_t block_size, size_t degree, size_t distance);
+    void onAccess(unsigned long long block_address, bool hit, bool prefetched_hit,
+                  std::vector<unsigned long long>& prefetches) override;
+    std::string getName() const override { return "next_line"; }
+};
+
+// Stride detector without instruction addresses: one entry per 4KB region remembers the last block
+// and stride seen there. Once the same stride repeats, the blocks distance .. distance + degree - 1
+// strides ahead are fetched.
+class StridePrefetcher : public Prefetcher {
+private:
+    struct Entry {
+        unsigned long long region;
+        long long last_block;
+        long long stride;      // in blocks
+        unsigned confidence;   // saturates at MAX_CONFIDENCE, prefetches from 1
+        bool valid;
+    };
+    static const size_t TABLE_SIZE = 64;
+    static const unsigned REGION_SHIFT = 12;
+    static const unsigned MAX_CONFIDENCE = 3;
+    std::vector<Entry> table;
+
+public:
+    StridePrefetcher(size_t block_size, size_t degree, size_t distance);
+    void onAccess(unsigned long long block_address, bool hit, bool prefetched_hit,
+                  std::vector<unsigned long long>& prefetches) override;
+    std::string getName() const override { return "stride"; }
+};
+
+// Stream buffers (Jouppi): a few FIFOs of degree sequential blocks held beside the cache, so
+// prefetches never evict cache lines. A miss found in a buffer is served from it, the entries
+// in front of it are discarded and the buffer is topped up; any other miss restarts the least
+// recently used buffer at distance blocks past the missing one.
+class StreamBufferPrefetcher : public Prefetcher {
+private:
+    struct Buffer {
+        std::vector<unsigned long long> blocks; // oldest first
+        unsigned long long next;                 // next block address to enqueue
+        unsigned long long last_use;
+    };
+    std::vector<Buffer> buffers;
+    unsigned long long clock;
+    size_t last_taken; // buffer that served the last takeBuffered() hit
+    size_t dropped;
+
+public:
+    static const size_t DEFAULT_BUFFERS = 4;
+
+    StreamBufferPrefetcher(size_t block_size, size_t degree, size_t distance, size_t num_buffers = DEFAULT_BUFFERS);
+    void onAccess(unsigned long long block_address, bool hit, bool prefetched_hit,
+                  std::vector<unsigned long long>& prefetches) override;
+    bool fillsCache() const override { return false; }
+    bool takeBuffered(unsigned long long block_address) override;
+    size_t getDropped() const override { return dropped; }
+    void resetStats() override { dropped = 0; }
+    std::string getName() const override { return "stream"; }
+};
+
+// "next_line", "stride", "stream"; nullptr for anything else
+std::unique_ptr<Prefetcher> createPrefetcher(const std::string& name, size_t block_size, size_t degree, size_t distance);
+
+#endif // PREFETCHER_H
@@ -0,0 +1,115 @@
+#ifndef SLAB_ALLOCATOR_H
+#define SLAB_ALLOCATOR_H
+
+#include "Block.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// One slab: a heap block cut into equal object slots, tracked by a 64-bit occupancy bitmap
+struct Slab {
+    Block* block;        // backing block in MemoryManager's list (USED, id 0)
+    size_t cls;
+    uint64_t used_mask;  // bit i set = slot i holds a live object
+    uint32_t used;
+    int state;           // list the slab is on (SlabAllocator::PARTIAL/FULL/EMPTY)
+    Slab* prev;
+    Slab* next;
+};
+
+// Per size class counters for the utilization report
+struct SlabClassStats {
+    size_t object_size;
+    size_t objects_per_slab;
+    size_t slabs[3];          // partial, full, empty
+    size_t live_objects;
+    size_t requested_bytes;   // sum of the live objects' requested sizes
+    size_t slabs_created;
+    size_t slabs_released;
+
+    size_t capacity() const { return (slabs[0] + slabs[1] + slabs[2]) * objects_per_slab; }
+    // live object bytes over slab bytes, 0..1
+    double utilization() const {
+        size_t bytes = capacity() * object_size;
+        return bytes ? (double)requested_bytes / bytes : 0.0;
+    }
+};
+
+/**
+ * @brief Slab caches for small fixed-size objects (slab allocator mode).
+ *
+ * Requests up to MAX_OBJECT_SIZE are rounded to a size class (8, 16, 32, 64, 96, 128, 192,
+ * 256, 512, 1024). Each class owns slabs of up to 64 slots, carved from the main heap by
+ * MemoryManager, on three lists: partial (allocations come from here first), full and empty.
+ * A freed slot never splits or merges heap blocks; only whole slabs move between this index
+ * and the heap. One empty slab per class is kept to absorb alloc/free ping-pong; any further
+ * empty slab is handed back to MemoryManager to be freed (and coalesced) in the heap.
+ */
+class SlabAllocator {
+public:
+    enum SlabList { PARTIAL = 0, FULL = 1, EMPTY = 2 };
+
+    static constexpr size_t MAX_OBJECT_SIZE = 1024;
+    static constexpr size_t MAX_SLOTS = 64;       // one bitmap word per slab
+    static constexpr size_t TARGET_SLAB_BYTES = 4096;
+    static constexpr size_t MAX_EMPTY_SLABS = 1;  // per class
+
+private:
+    struct SlabClass {
+        SlabClassStats stats;
+        Slab* lists[3];
+    };
+    struct SlabObject {
+        Slab* slab;
+        uint32_t slot;
+        size_t requested_size;
+    };
+
+    std::vector<SlabClass> classes;
+    std::unordered_map<int, SlabObject> objects;   // block id -> slot
+    std::unordered_map<const Block*, Slab*> slabs;  // backing block -> slab
+
+    void link(Slab* slab, int list);
+    void unlink(Slab* slab);
+
+public:
+    SlabAllocator();
+    ~SlabAllocator();
+
+    SlabAllocator(const SlabAllocator&) = delete;
+    SlabAllocator& operator=(const SlabAllocator&) = delete;
+
+    // forgets every slab and object (the heap they lived in is being re-initialized)
+    void reset();
+
+    bool handles(size_t size) const { return size > 0 && size <= MAX_OBJECT_SIZE; }
+    size_t classOf(size_t size) const;
+    size_t numClasses() const { return classes.size(); }
+    size_t slabBytes(size_t cls) const;
+
+    // a partial slab of class cls, else the retained empty one; nullptr if a new slab is needed
+    Slab* findSlab(size_t cls) const;
+    // registers a freshly carved backing block (size slabBytes(cls)) as an empty slab
+    Slab* addSlab(size_t cls, Block* block);
+    // takes the lowest free slot for object id; returns its address
+    size_t allocate(Slab* slab, int id, size_t requested_size);
+
+    /**
+     * @brief Frees object id. Returns false if id is not a slab object.
+     * @param released Set to the backing block when the slab became empty and is
+     * given back (the caller frees it in the heap), nullptr otherwise.
+     * @param retain_empty false gives every slab back as soon as it is empty (slab mode is off,
+     * so it would never be reused), instead of keeping up to MAX_EMPTY_SLABS per class.
+     */
+    bool free(int id, Block*& released, bool retain_empty = true);
+
+    // removes every empty slab; returns their backing blocks for the caller to free
+    std::vector<Block*> releaseEmptySlabs();
+
+    bool isSlabBlock(const Block* block) const { return slabs.count(block) != 0; }
+    size_t objectSizeOf(const Block* block) const;
+    bool hasObjects() const { return !objects.empty(); }
+    const SlabClassStats& getClassStats(size_t cls) const { return classes[cls].stats; }
+};
+
+#endif // SLAB_ALLOCATOR_H
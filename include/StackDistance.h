@@ -0,0 +1,74 @@
+#ifndef STACK_DISTANCE_H
+#define STACK_DISTANCE_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief LRU stack distance of a reference stream (Mattson), O(log n) per reference.
+ *
+ * Every block's most recent access time is marked in a Fenwick tree; the stack distance
+ * of a reuse is the number of marks after the block's previous access, i.e. the number
+ * of distinct blocks touched in between. When the time axis fills up, the live marks
+ * are renumbered in order (compaction), so memory stays proportional to the distinct blocks.
+ */
+class StackDistanceCounter {
+private:
+    std::vector<int> tree;                                    // Fenwick tree over time slots (1-based)
+    std::unordered_map<unsigned long long, size_t> last_use; // block -> time slot of its last access
+    size_t now;                                               // next free time slot
+    size_t live;                                              // number of marked slots
+
+    void add(size_t slot, int delta);
+    size_t prefix(size_t slot) const;
+    void compact();
+
+public:
+    static constexpr size_t COLD = ~(size_t)0;
+
+    StackDistanceCounter();
+
+    // returns the stack distance of the reference (0 = re-reference of the MRU block), COLD on first use
+    size_t access(unsigned long long block);
+};
+
+/**
+ * @brief Single-pass miss-ratio curve for LRU caches of every capacity.
+ *
+ * For a fixed block size, each configured set count keeps one stack per set. An LRU
+ * cache with S sets and A ways misses exactly on cold references and on references with
+ * per-set stack distance >= A, so one histogram per set count yields the misses of every
+ * associativity (and, for S = 1, of every fully associative capacity) at once.
+ */
+class StackDistanceAnalyzer {
+private:
+    size_t block_size;
+    unsigned block_shift;
+    std::vector<size_t> set_counts;                     // powers of two, 1 = fully associative
+    std::vector<std::vector<std::unique_ptr<StackDistanceCounter>>> stacks; // [config][set], created on first access
+    std::vector<std::vector<size_t>> histograms;        // [config][distance] -> references
+    std::vector<size_t> cold_misses;                    // [config]
+    size_t references;
+
+public:
+    // largest max_sets accepted; larger requests are clamped (callers should reject them first)
+    static constexpr size_t MAX_SETS = 1 << 16;
+
+    // max_sets: largest set count analysed (set counts 1, 2, 4, ... max_sets)
+    StackDistanceAnalyzer(size_t block_size, size_t max_sets);
+
+    void processBatch(const unsigned long long* addresses, size_t count);
+
+    // streams the whole file; returns false if it cannot be opened
+    bool run(const std::string& path);
+
+    // LRU misses of a cache with the given number of sets (must be analysed) and ways
+    size_t misses(size_t sets, size_t ways) const;
+
+    // miss-ratio table, one row per (sets, ways) up to the point where only cold misses remain
+    void printCurve() const;
+};
+
+#endif // STACK_DISTANCE_H
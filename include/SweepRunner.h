@@ -0,0 +1,80 @@
+#ifndef SWEEP_RUNNER_H
+#define SWEEP_RUNNER_H
+
+#include "CacheHierarchy.h"
+#include "PageTable.h"
+#include "TraceReplay.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+struct CacheConfig {
+    size_t size;
+    size_t block_size;
+    size_t associativity;
+    ReplacementPolicy policy;
+};
+
+struct VMConfig {
+    size_t phys_size;          // 0 = VM disabled
+    size_t page_size;
+    std::string policy;
+};
+
+// one point of the grid
+struct SweepConfig {
+    CacheConfig l1;
+    CacheConfig l2;
+    InclusionPolicy inclusion;
+    VMConfig vm;
+};
+
+/**
+ * @brief Replays one trace through a grid of independent simulator instances in parallel.
+ *
+ * The grid file lists candidate values per component, one per line; every combination
+ * (L1 x L2 x inclusion x VM) becomes one instance:
+ *
+ *   l1 <size> <block_size> <assoc> <fifo|lru>
+ *   l2 <size> <block_size> <assoc> <fifo|lru>
+ *   inclusion <nine|inclusive|exclusive>
+ *   vm <phys_size> [page_size] [policy]      or   vm off
+ *
+ * The trace is decoded once, in large batches, by the calling thread. Each batch is shared
+ * read-only by the workers, which claim whole instances from an atomic counter, so an
+ * instance is only ever touched by one thread per batch and the hot loop takes no locks.
+ * Decoding of the next batch overlaps with the simulation of the current one.
+ */
+class SweepRunner {
+private:
+    struct Instance {
+        SweepConfig config;
+        std::unique_ptr<CacheHierarchy> caches;
+        std::unique_ptr<VirtualMemoryManager> vm;
+        std::unique_ptr<TraceReplayer> replayer;
+    };
+
+    std::vector<SweepConfig> grid;
+    std::vector<Instance> instances;
+    double seconds;
+    size_t accesses;
+
+    // false (with a message) if a grid point is not a valid hierarchy
+    bool createInstances();
+
+public:
+    static const size_t BATCH_SIZE = 1 << 20;
+
+    SweepRunner();
+
+    // parses the grid file; false (with a message) on I/O or syntax errors
+    bool loadGrid(const std::string& path);
+    size_t size() const { return grid.size(); }
+
+    // threads = 0: one per hardware thread
+    bool run(const std::string& trace_path, size_t threads);
+
+    void printResults() const;
+};
+
+#endif // SWEEP_RUNNER_H
@@ -0,0 +1,72 @@
+#ifndef TLB_H
+#define TLB_H
+
+#include "Cache.h" // ReplacementPolicy
+#include <string>
+#include <vector>
+
+// One set-associative TLB level caching VPN -> PFN translations.
+// Same flat layout as CacheLevel: way w of set s at index s * associativity + w.
+class TLBLevel {
+private:
+    std::string name;
+    size_t num_entries;
+    size_t associativity;
+    size_t num_sets;
+    bool pow2_sets;             // index with a mask instead of a modulo
+    unsigned long long set_mask;
+    ReplacementPolicy policy;
+
+    static constexpr unsigned long long INVALID_VPN = ~0ULL;
+    std::vector<unsigned long long> vpns;
+    std::vector<int> pfns;
+    std::vector<unsigned long long> stamps; // FIFO: fill time, LRU: last access time
+    unsigned long long clock;
+
+    // stats
+    size_t hits;
+    size_t misses;
+    size_t shootdowns; // valid entries removed by invalidate()
+
+    size_t setBase(unsigned long long vpn) const {
+        return (size_t)(pow2_sets ? (vpn & set_mask) : (vpn % num_sets)) * associativity;
+    }
+
+public:
+    TLBLevel(std::string name, size_t entries, size_t associativity, ReplacementPolicy policy);
+
+    // returns true on Hit and sets pfn
+    bool lookup(unsigned long long vpn, int& pfn);
+    void insert(unsigned long long vpn, int pfn);
+    // drops the translation if present; returns true if an entry was removed
+    bool invalidate(unsigned long long vpn);
+
+    size_t getHits() const { return hits; }
+    size_t getMisses() const { return misses; }
+    void printStats() const;
+};
+
+/**
+ * @brief Two-level TLB: a small L1 dTLB backed by a larger L2 STLB.
+ * An L1 miss that hits the STLB refills the L1; a miss in both is a page walk,
+ * after which the translation is installed in both levels.
+ */
+class TLB {
+private:
+    TLBLevel l1;
+    TLBLevel l2;
+
+public:
+    TLB(size_t l1_entries, size_t l1_assoc, size_t l2_entries, size_t l2_assoc, ReplacementPolicy policy);
+
+    bool lookup(unsigned long long vpn, int& pfn);
+    void insert(unsigned long long vpn, int pfn);
+    // called when the page is evicted so no stale translation survives
+    void shootdown(unsigned long long vpn);
+
+    const TLBLevel& getL1() const { return l1; }
+    const TLBLevel& getL2() const { return l2; }
+    void printStats() const;
+};
+
+#endif // TLB_H
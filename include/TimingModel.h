@@ -0,0 +1,66 @@
+#ifndef TIMING_MODEL_H
+#define TIMING_MODEL_H
+
+#include "CacheHierarchy.h"
+#include "PageTable.h"
+#include <string>
+#include <vector>
+
+// Per-event costs in CPU cycles
+struct Latencies {
+    std::vector<unsigned long long> cache_hit; // hit latency of cache level i (missing levels: DEFAULT_LOWER_HIT)
+    unsigned long long memory;      // DRAM access after the last cache level
+    unsigned long long tlb_l1;      // L1 dTLB lookup (every translation)
+    unsigned long long tlb_l2;      // STLB lookup after an L1 dTLB miss
+    unsigned long long walk_ref;    // one page-table reference during a walk
+    unsigned long long page_fault;  // disk read servicing a fault
+    unsigned long long disk_write;  // writing a dirty victim page back
+
+    static constexpr unsigned long long DEFAULT_LOWER_HIT = 40;
+
+    Latencies() : cache_hit{4, 12, 40}, memory(200), tlb_l1(1), tlb_l2(7), walk_ref(30),
+                  page_fault(1000000), disk_write(1000000) {}
+
+    unsigned long long cacheHit(size_t level) const {
+        return level < cache_hit.size() ? cache_hit[level] : DEFAULT_LOWER_HIT;
+    }
+};
+
+/**
+ * @brief Turns the event counts of a run into simulated cycles.
+ *
+ * An access served by cache level s costs the hit latencies of levels 0..s (each level is
+ * looked up in turn); one served by memory costs every level plus the memory latency.
+ * Translation adds the TLB lookups, page-walk references and disk service times. Writebacks
+ * and prefetches are assumed to be off the critical path (buffered) and cost nothing.
+ * AMAT = total cycles / demand accesses.
+ */
+class TimingModel {
+private:
+    Latencies latencies;
+
+public:
+    // highest cache level whose latency can be set (l1..l16)
+    static constexpr size_t MAX_CACHE_LEVELS = 16;
+
+    TimingModel() = default;
+    explicit TimingModel(const Latencies& latencies) : latencies(latencies) {}
+
+    /**
+     * @brief Sets one latency by name: l1, l2, ... (cache levels), memory, tlb, stlb, walk, fault, diskwrite.
+     * @return false for an unknown name or a cache level outside l1..l<MAX_CACHE_LEVELS>
+     */
+    bool set(const std::string& component, unsigned long long cycles);
+    const Latencies& getLatencies() const { return latencies; }
+
+    // cycles spent by the demand accesses counted in caches (cache levels + memory only)
+    unsigned long long memoryCycles(const CacheHierarchy& caches) const;
+    // total cycles including translation; vm may be nullptr
+    unsigned long long totalCycles(const CacheHierarchy& caches, const VirtualMemoryManager* vm) const;
+    double amat(const CacheHierarchy& caches, const VirtualMemoryManager* vm) const;
+
+    // total cycles, AMAT and where the time went
+    void printReport(const CacheHierarchy& caches, const VirtualMemoryManager* vm) const;
+};
+
+#endif // TIMING_MODEL_H
@@ -0,0 +1,107 @@
+#ifndef TRACE_REPLAY_H
+#define TRACE_REPLAY_H
+
+#include "CacheHierarchy.h"
+#include "CompactTrace.h"
+#include "Metrics.h"
+#include "Workload.h"
+#include "PageTable.h"
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Buffered reader for text address traces.
+ *
+ * One address per line, parsed like the interactive `access` command
+ * (0x prefix = hex, leading 0 = octal, otherwise decimal). An optional leading
+ * "access" keyword is accepted so CLI scripts can be replayed as-is.
+ * The address may be preceded by an access type: R/L/load, W/S/M/store or I/ifetch
+ * (case-insensitive); untyped lines are loads.
+ * Multicore traces start each line with the decimal id of the issuing core: "<core> [type] <address>".
+ * Blank lines and lines starting with '#' are skipped.
+ * Files in the compact binary format (CompactTrace.h) are detected by their magic and
+ * decoded through CompactTraceReader instead; they carry no core ids.
+ */
+class TraceReader {
+private:
+    FILE* file;
+    std::unique_ptr<CompactTraceReader> compact; // set for compact traces
+    std::vector<char> buffer;
+    size_t pos;           // next unread byte in buffer
+    size_t len;           // valid bytes in buffer
+    bool at_eof;          // no more data to pull from the file
+    size_t malformed_lines;
+
+    bool refill();
+    // returns pointer to the next complete line (without '\n') or nullptr at end of trace
+    const char* nextLine(size_t& line_len);
+
+public:
+    explicit TraceReader(const std::string& path);
+    ~TraceReader();
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    bool isOpen() const { return file != nullptr || (compact && compact->isOpen()); }
+    bool isCompact() const { return compact != nullptr; }
+
+    /**
+     * @brief Decodes up to max addresses from the trace.
+     *
+     * @param types Receives the access type of each address; may be nullptr.
+     * @return size_t Number of addresses written to out, 0 at end of trace.
+     */
+    size_t readBatch(unsigned long long* out, AccessType* types, size_t max) { return readBatch(out, types, nullptr, max); }
+    size_t readBatch(unsigned long long* out, size_t max) { return readBatch(out, nullptr, nullptr, max); }
+    // cores != nullptr: lines carry a leading core id, written to cores
+    size_t readBatch(unsigned long long* out, AccessType* types, unsigned* cores, size_t max);
+
+    size_t getMalformedLines() const { return malformed_lines; }
+};
+
+struct ReplayStats {
+    size_t accesses;
+    size_t memory_accesses; // misses in every cache level
+    size_t stores;
+    double seconds;
+
+    ReplayStats() : accesses(0), memory_accesses(0), stores(0), seconds(0.0) {}
+};
+
+/**
+ * @brief Drives addresses through VM translation and the cache hierarchy
+ * without any per-access console output.
+ */
+class TraceReplayer {
+private:
+    VirtualMemoryManager* vm; // nullptr when VM is disabled
+    CacheHierarchy& caches;
+    IntervalSampler* sampler; // optional, not owned
+    ReplayStats stats;
+
+    void processRange(const unsigned long long* addresses, const AccessType* types, size_t count);
+
+public:
+    static constexpr size_t BATCH_SIZE = 1 << 16;
+
+    TraceReplayer(VirtualMemoryManager* vm, CacheHierarchy& caches);
+
+    // rows are written to sampler every N accesses; nullptr disables sampling
+    void setSampler(IntervalSampler* _sampler) { sampler = _sampler; }
+
+    // hot loop: translate + cache lookup for each address; types == nullptr means all loads
+    void processBatch(const unsigned long long* addresses, const AccessType* types, size_t count);
+
+    // streams the whole file; returns false if it cannot be opened
+    bool run(const std::string& path);
+    // replays count generated accesses, batch by batch, without going through text
+    void run(AddressGenerator& generator, size_t count);
+
+    void printStats() const;
+    const ReplayStats& getStats() const { return stats; }
+};
+
+#endif // TRACE_REPLAY_H
@@ -0,0 +1,253 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include "Cache.h" // AccessType
+#include "MemoryManager.h"
+#include <cstdint>
+#include <memory>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// SplitMix64: small, fast and good enough for workload synthesis; same seed, same stream
+class WorkloadRng {
+private:
+    uint64_t state;
+
+public:
+    explicit WorkloadRng(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    // uniform in [0, n); the modulo bias is negligible for simulation-sized n
+    uint64_t below(uint64_t n) { return next() % n; }
+    // uniform in [0, 1)
+    double unit() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+};
+
+/**
+ * @brief Zipf(n, alpha) sampler returning ranks 0..n-1, rank 0 being the most popular.
+ *
+ * Up to ALIAS_LIMIT items it uses Vose's alias table (one random number and one table probe per
+ * sample, 8 bytes per item); beyond that, rejection-inversion (Hörmann & Derflinger), which needs
+ * no table but a few transcendental calls per sample.
+ */
+class ZipfSampler {
+private:
+    uint64_t n;
+    double alpha;
+    double h_integral_x1;
+    double h_integral_n;
+    double s;
+    std::vector<float> alias_prob;      // empty: rejection-inversion
+    std::vector<uint32_t> alias_index;
+
+    void buildAliasTable();
+    double h(double x) const;
+    double hIntegral(double x) const;
+    double hIntegralInverse(double x) const;
+
+public:
+    static const uint64_t ALIAS_LIMIT = 1 << 21;
+
+    ZipfSampler(uint64_t n, double alpha);
+
+    uint64_t sample(WorkloadRng& rng) const {
+        if (alias_prob.empty()) return sampleRejection(rng);
+        uint64_t r = rng.next();
+        uint64_t i = ((r >> 32) * n) >> 32;                           // uniform column
+        float u = (float)(r & 0xFFFFFFFFULL) * (1.0f / 4294967296.0f); // coin within the column
+        return u < alias_prob[i] ? i : alias_index[i];
+    }
+    uint64_t sampleRejection(WorkloadRng& rng) const;
+};
+
+enum class AddressPattern {
+    SEQUENTIAL,    // 8-byte steps through the working set
+    STRIDED,       // fixed stride, wrapping inside the working set
+    UNIFORM,       // random granule of the working set
+    ZIPF,          // random granule, Zipf-distributed popularity
+    POINTER_CHASE  // walk a random cyclic permutation of the granules (dependent loads)
+};
+
+bool parseAddressPattern(const std::string& name, AddressPattern& pattern);
+const char* addressPatternName(AddressPattern pattern);
+
+struct AddressStreamConfig {
+    AddressPattern pattern;
+    unsigned long long base;   // start of the first working set
+    size_t working_set;        // bytes
+    size_t granule;            // bytes per item for uniform, zipf and pointer_chase
+    size_t stride;             // strided only
+    double alpha;              // zipf exponent
+    double write_ratio;        // share of accesses that are stores
+    size_t phase_length;       // accesses per phase; each phase moves to a fresh working set (0 = one phase)
+    uint64_t seed;
+
+    AddressStreamConfig()
+        : pattern(AddressPattern::UNIFORM), base(0), working_set(1 << 20), granule(64), stride(4096),
+          alpha(0.99), write_ratio(0.0), phase_length(0), seed(1) {}
+};
+
+/**
+ * @brief Endless seeded address stream written straight into replay batches (no text parsing).
+ *
+ * Phase changes: after every phase_length accesses the working set slides to the next
+ * disjoint region (base + k * working_set) and the pattern restarts there, which models a
+ * program moving between data structures.
+ */
+class AddressGenerator {
+private:
+    AddressStreamConfig config;
+    WorkloadRng rng;
+    std::unique_ptr<ZipfSampler> zipf; // zipf only
+    std::vector<uint32_t> chase_next; // pointer_chase: successor of each granule
+    uint64_t items;                   // granules in the working set
+    uint64_t write_threshold;         // next() below this is a store
+    unsigned long long phase_base;
+    size_t phase_left;
+    uint64_t position;                // byte offset (sequential/strided) or item (pointer_chase)
+
+public:
+    // pointer_chase keeps a 4-byte successor per granule; larger working sets are cut to this many granules
+    static constexpr uint64_t MAX_CHASE_ITEMS = 1ULL << 26;
+
+    explicit AddressGenerator(const AddressStreamConfig& config);
+
+    // writes max addresses (and access types unless types is nullptr); the stream never ends
+    void fill(unsigned long long* out, AccessType* types, size_t max);
+    const AddressStreamConfig& getConfig() const { return config; }
+};
+
+enum class SizeDistribution {
+    FIXED,        // always min_size
+    UNIFORM,      // [min_size, max_size]
+    EXPONENTIAL,  // mean mean_size, clamped to [min_size, max_size]
+    POWER_OF_TWO  // 2^k uniformly between min_size and max_size (size-class heavy workloads)
+};
+
+bool parseSizeDistribution(const std::string& name, SizeDistribution& dist);
+
+struct AllocationStreamConfig {
+    SizeDistribution sizes;
+    size_t min_size;
+    size_t max_size;
+    size_t mean_size;
+    double mean_lifetime;      // operations an allocation stays live
+    bool fixed_lifetime;       // false: exponentially distributed lifetimes
+    uint64_t seed;
+
+    AllocationStreamConfig()
+        : sizes(SizeDistribution::UNIFORM), min_size(16), max_size(1024), mean_size(128),
+          mean_lifetime(1000.0), fixed_lifetime(false), seed(1) {}
+};
+
+enum class AllocOpType : uint8_t {
+    MALLOC,
+    FREE,
+    REALLOC   // free the handle's block (if live) and allocate size bytes under the same handle
+};
+
+// one heap operation on a caller-chosen handle
+struct AllocOp {
+    AllocOpType op;
+    uint32_t handle;      // dense: generators and importers reuse handles after their free
+    uint64_t size;        // malloc/realloc only
+    uint64_t timestamp;   // trace time; generators use the operation index
+};
+
+/**
+ * @brief Seeded malloc/free stream. Every malloc draws a size and a lifetime; the matching free
+ * is emitted once that many operations have passed. In steady state about mean_lifetime / 2
+ * blocks are live.
+ */
+class AllocationGenerator {
+private:
+    struct Death {
+        uint64_t time;
+        uint32_t handle;
+        bool operator>(const Death& other) const { return time > other.time; }
+    };
+
+    AllocationStreamConfig config;
+    WorkloadRng rng;
+    uint64_t now;
+    std::priority_queue<Death, std::vector<Death>, std::greater<Death>> deaths;
+    std::vector<uint32_t> free_handles;
+    uint32_t next_handle;
+
+    size_t drawSize();
+    uint64_t drawLifetime();
+
+public:
+    explicit AllocationGenerator(const AllocationStreamConfig& config);
+
+    void fill(AllocOp* out, size_t max);
+};
+
+struct AllocationRunStats {
+    size_t mallocs;
+    size_t frees;
+    size_t reallocs;
+    size_t failures;      // mallocs/reallocs the heap could not satisfy (their frees are skipped)
+    size_t malformed;     // trace records with a handle outside the header's handle count (skipped)
+    double seconds;
+
+    AllocationRunStats() : mallocs(0), frees(0), reallocs(0), failures(0), malformed(0), seconds(0.0) {}
+};
+
+class AllocTraceReader;
+class IntervalSampler;
+
+/**
+ * @brief Applies malloc/free operations to a MemoryManager with its output silenced,
+ * mapping caller handles to the block IDs the heap hands out.
+ */
+class AllocationDriver {
+private:
+    // handles below this map through the flat array; larger ones (sparse or hostile traces) through a hash map
+    static constexpr uint64_t DENSE_HANDLES = 1 << 22;
+
+    MemoryManager& heap;
+    std::vector<int> block_ids;                  // handle -> block ID, -1 when not live
+    std::unordered_map<uint32_t, int> sparse_ids; // handles >= DENSE_HANDLES that are live
+    uint64_t handle_limit;                       // handles at or above this are malformed
+    IntervalSampler* sampler;                    // optional, not owned
+    AllocationRunStats stats;
+
+    int& blockSlot(uint32_t handle);
+    // apply(), split at sampling boundaries when a sampler is set
+    void applyBatch(const AllocOp* ops, size_t count);
+
+public:
+    explicit AllocationDriver(MemoryManager& heap) : heap(heap), handle_limit(UINT64_MAX), sampler(nullptr) {}
+
+    // rows (heap fragmentation, free blocks) are written to sampler every N operations; nullptr disables sampling
+    void setSampler(IntervalSampler* _sampler) { sampler = _sampler; }
+
+    void apply(const AllocOp* ops, size_t count);
+    // generates and applies count operations in batches
+    void run(AllocationGenerator& generator, size_t count);
+    // applies every record of a binary allocation trace
+    void run(AllocTraceReader& reader);
+
+    const AllocationRunStats& getStats() const { return stats; }
+    void printStats() const;
+};
+
+/**
+ * @brief Parses "key=value" options (after the pattern name) into a stream config.
+ * Sizes accept K/M/G suffixes. Address keys: ws, granule, stride, alpha, writes, phase, base, seed.
+ * pointer_chase working sets are limited to AddressGenerator::MAX_CHASE_ITEMS granules.
+ * Allocation keys: dist, min, max, mean, life, lifetime (exp|fixed), seed.
+ * @return false (with a message) on an unknown key or bad value
+ */
+bool parseAddressOptions(const std::vector<std::string>& options, AddressStreamConfig& config);
+bool parseAllocationOptions(const std::vector<std::string>& options, AllocationStreamConfig& config);
+
+#endif // WORKLOAD_H
@@ -1,33 +1,35 @@
 #include "../include/MemoryManager.h"
 #include "../include/AllocatorStrategies.h"
 #include "buddy/BuddyUtils.h"
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
 
-MemoryManager::MemoryManager() : total_memory_size(0), memory_head(nullptr), next_block_id(1), is_buddy_mode(false), alloc_attempts(0), alloc_failures(0) {
+MemoryManager::MemoryManager() : total_memory_size(0), memory_head(nullptr), next_block_id(1), is_buddy_mode(false), verbose(true), is_slab_mode(false), alloc_attempts(0), alloc_failures(0), lock_contention(0) {
     // Default to First Fit
     allocator = std::make_unique<FirstFit>();
 }
 
 MemoryManager::~MemoryManager() {
-    Block* current = memory_head;
-    while (current) {
-        Block* next = current->next;
-        delete current;
-        current = next;
+    // Block nodes are released with block_pool
+}
+
+std::unique_lock<std::mutex> MemoryManager::lockHeap() const {
+    std::unique_lock<std::mutex> lock(heap_mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        lock_contention.fetch_add(1, std::memory_order_relaxed);
+        lock.lock();
     }
+    return lock;
 }
 
 void MemoryManager::init(size_t size) {
-    if (memory_head) {
-        // Clear existing memory
-        Block* current = memory_head;
-        while (current) {
-            Block* next = current->next;
-            delete current;
-            current = next;
-        }
-    }
+    auto lock = lockHeap();
+    // Clear existing memory: all nodes go back to the pool at once
+    block_pool.reset();
+    memory_head = nullptr;
+    block_index.clear();
+    slab_allocator.reset();
     
     // Reset stats
     alloc_attempts = 0;
@@ -42,34 +44,108 @@ void MemoryManager::init(size_t size) {
 
     total_memory_size = size;
     // Initial single free block covering entire memory
-    memory_head = new Block(0, 0, size, true);
+    memory_head = block_pool.create(0, 0, size, true);
     next_block_id = 1;
-    std::cout << "Memory initialized with " << size << " units." << std::endl;
+    rebuildFreeIndex();
+    if (verbose) std::cout << "Memory initialized with " << size << " units." << std::endl;
 }
 
 void MemoryManager::setAllocator(const std::string& type) {
+    auto lock = lockHeap();
+    // cached empty slabs become ordinary free space for the new strategy's index
+    for (Block* block : slab_allocator.releaseEmptySlabs()) {
+        block->is_free = true;
+        block->requested_size = 0;
+    }
     is_buddy_mode = false;
+    is_slab_mode = false;
     if (type == "first_fit") {
         allocator = std::make_unique<FirstFit>();
     } else if (type == "best_fit") {
         allocator = std::make_unique<BestFit>();
     } else if (type == "worst_fit") {
         allocator = std::make_unique<WorstFit>();
+    } else if (type == "tlsf") {
+        allocator = std::make_unique<TLSF>();
     } else if (type == "buddy") {
         is_buddy_mode = true;
-        // Buddy uses a specific logic that overrides standard strategies, 
-        // but we can default to First Fit for finding blocks before splitting
+        // Buddy uses its own per-order free lists (buddy_system); the strategy
+        // object is kept only so switching back has a valid allocator
         allocator = std::make_unique<FirstFit>();
-        std::cout << "Allocator set to Buddy System. (Please re-init memory if not power of 2)" << std::endl;
+        rebuildFreeIndex();
+        if (verbose) std::cout << "Allocator set to Buddy System. (Please re-init memory if not power of 2)" << std::endl;
         return; 
+    } else if (type == "slab") {
+        // slabs and requests above the largest slab class come from First Fit
+        is_slab_mode = true;
+        allocator = std::make_unique<FirstFit>();
+        rebuildFreeIndex();
+        if (verbose) std::cout << "Allocator set to Slab (classes up to " << SlabAllocator::MAX_OBJECT_SIZE
+                               << " bytes, First Fit for slabs and larger requests)" << std::endl;
+        return;
     } else {
         std::cout << "Unknown allocator type. Defaulting to First Fit." << std::endl;
         allocator = std::make_unique<FirstFit>();
     }
-    std::cout << "Allocator set to " << allocator->getName() << std::endl;
+    // the new strategy starts with an empty index; seed it from the current heap
+    rebuildFreeIndex();
+    if (verbose) std::cout << "Allocator set to " << allocator->getName() << std::endl;
+}
+
+void MemoryManager::rebuildFreeIndex() {
+    allocator->clear();
+    if (is_buddy_mode) {
+        buddy_system.reset(total_memory_size);
+        Block* current = memory_head;
+        while (current) {
+            // releasing may merge current into an earlier block, so step first
+            Block* next = current->next;
+            if (current->is_free) releaseBuddyBlock(current);
+            current = next;
+        }
+        return;
+    }
+    for (Block* current = memory_head; current; current = current->next) {
+        if (!current->is_free) continue;
+        // buddy halves left behind by a mode switch: the non-buddy paths expect no free neighbours
+        while (current->next && current->next->is_free) {
+            absorbNext(current);
+        }
+        allocator->addFreeBlock(current);
+    }
+}
+
+Block* MemoryManager::splitBlock(Block* block, size_t size) {
+    Block* rest = block_pool.create(0, block->start_address + size, block->size - size, true);
+
+    rest->next = block->next;
+    rest->prev = block;
+    if (block->next) {
+        block->next->prev = rest;
+    }
+    block->next = rest;
+
+    block->size = size;
+    return rest;
 }
 
 int MemoryManager::my_malloc(size_t size) {
+    auto lock = lockHeap();
+    return mallocLocked(size);
+}
+
+size_t MemoryManager::mallocBatch(size_t size, size_t count, std::vector<int>& out) {
+    auto lock = lockHeap();
+    size_t n = 0;
+    for (; n < count; ++n) {
+        int id = mallocLocked(size);
+        if (id < 0) break;
+        out.push_back(id);
+    }
+    return n;
+}
+
+int MemoryManager::mallocLocked(size_t size) {
     if (!memory_head) {
         std::cerr << "Error: Memory not initialized." << std::endl;
         return -1;
@@ -80,175 +156,217 @@ int MemoryManager::my_malloc(size_t size) {
     // Buddy System Allocation Logic
     if (is_buddy_mode) {
         size_t req_size = nextPowerOf2(size);
-        // Scan for the *smallest* free block that is >= req_size (Best Fit approach essentially)
-        
-        Block* current = memory_head;
-        Block* target = nullptr;
-        size_t min_suitable = total_memory_size + 1;
-        
-        while(current) {
-            if (current->is_free && current->size >= req_size) {
-                 if (current->size < min_suitable) {
-                     min_suitable = current->size;
-                     target = current;
-                 }
-            }
-            current = current->next;
-        }
+        // smallest free order >= req_size, lowest address first
+        Block* target = buddy_system.findFreeBlock(req_size);
 
         if (!target) {
-            std::cerr << "Fail: No suitable block found for Buddy request " << req_size << std::endl;
+            if (verbose) std::cerr << "Fail: No suitable block found for Buddy request " << req_size << std::endl;
             alloc_failures++;
             return -1;
         }
 
-        // Split recursively
+        // Split recursively: target keeps the left half, the right half is a free buddy
+        buddy_system.removeFreeBlock(target);
         while (target->size > req_size) {
-            // Split in half
-            size_t half_size = target->size / 2;
-            size_t new_addr = target->start_address + half_size;
-            
-            Block* buddy = new Block(0, new_addr, half_size, true);
-            
-            // Link
-            buddy->next = target->next;
-            buddy->prev = target;
-            if (target->next) target->next->prev = buddy;
-            target->next = buddy;
-            
-            target->size = half_size; // Target becomes the left half
-            // Continue loop: target is still the block we are looking at, but smaller.
+            Block* buddy = splitBlock(target, target->size / 2);
+            buddy_system.addFreeBlock(buddy);
         }
         
         target->is_free = false;
         target->id = next_block_id++;
         target->requested_size = size; // Track for internal fragmentation
-        std::cout << "Allocated Buddy Block id=" << target->id << " (Size: " << target->size << ") at 0x" 
+        block_index[target->id] = target;
+        if (verbose) std::cout << "Allocated Buddy Block id=" << target->id << " (Size: " << target->size << ") at 0x" 
                   << std::hex << target->start_address << std::dec << std::endl;
         return target->id;
     }
 
+    if (is_slab_mode && slab_allocator.handles(size)) {
+        int id = slabMalloc(size);
+        if (id >= 0) return id;
+        // no room for a whole slab: the object may still fit as a plain block
+    }
+
     // Standard Allocation Logic (First/Best/Worst Fit)
-    Block* target = allocator->findFreeBlock(memory_head, size);
+    Block* target = takeFreeBlock(size);
 
     if (!target) {
-        std::cerr << "Fail: No suitable block found for size " << size << std::endl;
+        if (verbose) std::cerr << "Fail: No suitable block found for size " << size << std::endl;
         alloc_failures++;
         return -1;
     }
 
-    if (target->size > size) {
-        size_t remaining_size = target->size - size;
-        size_t new_start_addr = target->start_address + size;
-        
-        Block* new_block = new Block(0, new_start_addr, remaining_size, true);
-        
-        new_block->next = target->next;
-        new_block->prev = target;
-        if (target->next) {
-            target->next->prev = new_block;
-        }
-        target->next = new_block;
-        
-        target->size = size;
-    }
-
-    target->is_free = false;
     target->id = next_block_id++;
     target->requested_size = size;
+    block_index[target->id] = target;
 
-    std::cout << "Allocated block id=" << target->id << " at address=0x" 
+    if (verbose) std::cout << "Allocated block id=" << target->id << " at address=0x" 
               << std::hex << std::uppercase << target->start_address << std::dec << std::endl;
 
     return target->id;
 }
 
+Block* MemoryManager::takeFreeBlock(size_t size) {
+    Block* target = allocator->findFreeBlock(size);
+    if (!target) {
+        // memory pressure: give the empty slabs kept for reuse back to the heap and retry
+        std::vector<Block*> empty_slabs = slab_allocator.releaseEmptySlabs();
+        if (empty_slabs.empty()) return nullptr;
+        for (Block* block : empty_slabs) {
+            block->requested_size = 0;
+            releaseBlock(block);
+        }
+        target = allocator->findFreeBlock(size);
+        if (!target) return nullptr;
+    }
+
+    allocator->removeFreeBlock(target);
+    if (target->size > size) {
+        Block* new_block = splitBlock(target, size);
+        allocator->addFreeBlock(new_block);
+    }
+    target->is_free = false;
+    return target;
+}
+
+int MemoryManager::slabMalloc(size_t size) {
+    size_t cls = slab_allocator.classOf(size);
+    Slab* slab = slab_allocator.findSlab(cls);
+    if (!slab) {
+        Block* backing = takeFreeBlock(slab_allocator.slabBytes(cls));
+        if (!backing) {
+            if (verbose) std::cout << "No room for a new " << slab_allocator.slabBytes(cls)
+                                   << "-byte slab; allocating " << size << " bytes as a plain block" << std::endl;
+            return -1;
+        }
+        backing->id = 0;
+        backing->requested_size = 0;
+        slab = slab_allocator.addSlab(cls, backing);
+    }
+
+    int id = next_block_id++;
+    size_t address = slab_allocator.allocate(slab, id, size);
+    if (verbose) std::cout << "Allocated slab object id=" << id << " (class " << slab_allocator.getClassStats(cls).object_size
+                           << ") at address=0x" << std::hex << std::uppercase << address << std::dec << std::endl;
+    return id;
+}
+
+void MemoryManager::releaseBlock(Block* block) {
+    block->is_free = true;
+    if (is_buddy_mode) {
+        releaseBuddyBlock(block); // Recursive buddy merge
+    } else {
+        coalesce(block); // Simple merge
+    }
+}
+
 bool MemoryManager::my_free(int block_id) {
-    Block* current = memory_head;
-    while (current) {
-        if (!current->is_free && current->id == block_id) {
-            current->is_free = true;
-            std::cout << "Block " << block_id << " freed." << std::endl;
-            
-            if (is_buddy_mode) {
-                coalesceBuddy(); // Recursive buddy merge
-            } else {
-                coalesce(); // Simple merge
+    auto lock = lockHeap();
+    return freeLocked(block_id);
+}
+
+size_t MemoryManager::freeBatch(const std::vector<int>& ids) {
+    auto lock = lockHeap();
+    size_t freed = 0;
+    for (int id : ids) freed += freeLocked(id);
+    return freed;
+}
+
+bool MemoryManager::freeLocked(int block_id) {
+    auto it = block_index.find(block_id);
+    if (it == block_index.end()) {
+        // slab objects are not blocks; they may outlive slab mode
+        Block* empty_slab = nullptr;
+        if (slab_allocator.free(block_id, empty_slab, is_slab_mode)) {
+            if (verbose) std::cout << "Block " << block_id << " freed." << std::endl;
+            if (empty_slab) {
+                empty_slab->requested_size = 0;
+                releaseBlock(empty_slab);
+                if (verbose) std::cout << "Empty slab returned to the heap." << std::endl;
             }
             return true;
         }
-        current = current->next;
+        std::cerr << "Error: Block ID " << block_id << " not found or already free." << std::endl;
+        return false;
+    }
+
+    Block* block = it->second;
+    block_index.erase(it);
+    if (verbose) std::cout << "Block " << block_id << " freed." << std::endl;
+    releaseBlock(block);
+    return true;
+}
+
+void MemoryManager::absorbNext(Block* block) {
+    Block* next_block = block->next;
+
+    block->size += next_block->size;
+    block->next = next_block->next;
+    if (next_block->next) {
+        next_block->next->prev = block;
     }
-    std::cerr << "Error: Block ID " << block_id << " not found or already free." << std::endl;
-    return false;
+    block_pool.destroy(next_block);
 }
 
-void MemoryManager::coalesce() {
+// Only the freed block's neighbours can be free (every free already merged the rest),
+// so merging is local to prev/next instead of a walk over the whole list.
+void MemoryManager::coalesce(Block* block) {
     bool merged = false;
-    Block* current = memory_head;
-    
-    while (current && current->next) {
-        if (current->is_free && current->next->is_free) {
-            // Merge with next
-            Block* next_block = current->next;
-            
-            current->size += next_block->size;
-            current->next = next_block->next;
-            
-            if (next_block->next) {
-                next_block->next->prev = current;
-            }
-            
-            delete next_block;
-            merged = true;
-            // Do not advance current, check if new next is also free
-        } else {
-            current = current->next;
-        }
+
+    while (block->prev && block->prev->is_free) {
+        Block* prev = block->prev;
+        allocator->removeFreeBlock(prev);
+        absorbNext(prev);
+        block = prev;
+        merged = true;
+    }
+    while (block->next && block->next->is_free) {
+        allocator->removeFreeBlock(block->next);
+        absorbNext(block);
+        merged = true;
     }
-    if (merged) {
+
+    allocator->addFreeBlock(block);
+    if (merged && verbose) {
         std::cout << "Adjacent free blocks merged." << std::endl;
     }
 }
 
-// Buddy Coalescing: Only merge if they are valid buddies
-// Buddies are blocks of same size size = 2^k
-// And satisfy: address differences match buddy logic XOR
-// Here, since we have a sorted list (by address), buddies are always adjacent.
-// We just need to check if Address % (2 * Size) == 0 implies it's the "Left" buddy.
-void MemoryManager::coalesceBuddy() {
-    bool merged = true;
-    while (merged) {
-        merged = false;
-        Block* current = memory_head;
-        while (current && current->next) {
-            Block* next = current->next;
-            if (current->is_free && next->is_free && current->size == next->size) {
-                // Must verify they are actual buddies
-                // Buddy check: (Addr / Size) % 2 == 0 for left buddy
-                // Actually simply: Left Buddy Address % (2 * current->size) == 0
-                // Example: Size 4. Addr 0 and 4 are buddies (0 % 8 == 0).
-                // Example: Size 4. Addr 4 and 8 are NOT buddies (4 % 8 != 0).
-                
-                size_t combined_size = current->size * 2;
-                if (current->start_address % combined_size == 0) {
-                    // They are buddies, merge them
-                    current->size = combined_size;
-                    current->next = next->next;
-                    if (next->next) next->next->prev = current;
-                    delete next;
-                    merged = true;
-                    // Restart scan or continue? Restarting is safer to catch cascading merges
-                    break;
-                }
-            }
-            current = current->next;
+// Buddy Coalescing: merge with the buddy (address XOR size) while it is free and of the
+// same order, then index the result. Each step is a bitmap test plus an O(log n) list update,
+// so a free is O(log N) instead of rescanning the block list after every merge.
+void MemoryManager::mergeBuddies(Block* block) {
+    Block* buddy;
+    while ((buddy = buddy_system.findFreeBuddy(block)) != nullptr) {
+        buddy_system.removeFreeBlock(buddy);
+        if (buddy->start_address < block->start_address) {
+            absorbNext(buddy); // buddy is the left half
+            block = buddy;
+        } else {
+            absorbNext(block);
         }
     }
+    buddy_system.addFreeBlock(block);
 }
 
+// Free blocks left by another strategy (switching to buddy without re-init) are not
+// necessarily power-of-2 aligned; carve them into aligned power-of-2 pieces first.
+void MemoryManager::releaseBuddyBlock(Block* block) {
+    while (block && block->size > 0) {
+        Block* rest = nullptr;
+        if (!BuddySystem::isBuddyBlock(block)) {
+            size_t align = block->start_address & (~block->start_address + 1);
+            size_t piece = (size_t)1 << floorLog2(block->size);
+            if (align != 0 && align < piece) piece = align;
+            rest = splitBlock(block, piece);
+        }
+        mergeBuddies(block);
+        block = rest;
+    }
+}
 
 void MemoryManager::dumpMemory() const {
+    auto lock = lockHeap();
     std::cout << "\n--- Memory Dump ---" << std::endl;
     Block* current = memory_head;
     while (current) {
@@ -258,7 +376,11 @@ void MemoryManager::dumpMemory() const {
                   << (current->start_address + current->size - 1) << std::dec 
                   << "] " << (current->is_free ? "FREE" : "USED")
                   << " (Size: " << current->size;
-        if (!current->is_free) std::cout << ", ID: " << current->id;
+        if (slab_allocator.isSlabBlock(current)) {
+            std::cout << ", Slab: " << slab_allocator.objectSizeOf(current) << "-byte objects";
+        } else if (!current->is_free) {
+            std::cout << ", ID: " << current->id;
+        }
         std::cout << ")" << std::endl;
         
         current = current->next;
@@ -266,33 +388,36 @@ void MemoryManager::dumpMemory() const {
     std::cout << "-------------------\n" << std::endl;
 }
 
-void MemoryManager::printStats() const {
-    size_t free_mem = 0;
-    size_t used_mem = 0;
-    size_t internal_frag_bytes = 0;
-    size_t max_free_block = 0;
-    int free_blocks = 0;
+HeapStats MemoryManager::getHeapStats() const {
+    auto lock = lockHeap();
+    HeapStats stats = {total_memory_size, 0, 0, 0, 0, 0, alloc_attempts, alloc_failures};
 
     Block* current = memory_head;
     while (current) {
         if (current->is_free) {
-            free_mem += current->size;
-            if (current->size > max_free_block) max_free_block = current->size;
-            free_blocks++;
+            stats.free_memory += current->size;
+            if (current->size > stats.largest_free_block) stats.largest_free_block = current->size;
+            stats.free_blocks++;
         } else {
-            used_mem += current->size;
+            stats.used_memory += current->size;
             // Internal fragmentation = Allocated Size - Requested Size
-            if (current->size > current->requested_size) {
-                internal_frag_bytes += (current->size - current->requested_size);
-            }
+            stats.requested_memory += std::min(current->size, current->requested_size);
         }
         current = current->next;
     }
+    return stats;
+}
+
+void MemoryManager::printStats() const {
+    HeapStats stats = getHeapStats();
+    size_t free_mem = stats.free_memory;
+    size_t used_mem = stats.used_memory;
+    size_t internal_frag_bytes = stats.internalFragmentation();
 
-    std::cout << "Total Memory: " << total_memory_size << "\n"
-              << "Used Memory:  " << used_mem << " (Requested: " << (used_mem - internal_frag_bytes) << ")\n"
+    std::cout << "Total Memory: " << stats.total_memory << "\n"
+              << "Used Memory:  " << used_mem << " (Requested: " << stats.requested_memory << ")\n"
               << "Free Memory:  " << free_mem << "\n"
-              << "Free Blocks:  " << free_blocks << "\n";
+              << "Free Blocks:  " << stats.free_blocks << "\n";
               
     // External Fragmentation: 
     // Usually defined as 1 - (Largest Free Block / Total Free Memory)
@@ -301,7 +426,7 @@ void MemoryManager::printStats() const {
     // A simple metric: (Total Free - Largest Free) / Total Free * 100
     
     if (free_mem > 0) {
-        double frag_percent = ((double)(free_mem - max_free_block) / free_mem) * 100.0;
+        double frag_percent = stats.externalFragmentation() * 100.0;
         std::cout << "External Fragmentation: " << std::fixed << std::setprecision(2) << frag_percent << "%" << "\n";
     } else {
         std::cout << "External Fragmentation: 0%" << "\n";
@@ -317,11 +442,28 @@ void MemoryManager::printStats() const {
     }
 
     // Allocation Stats
-    if (alloc_attempts > 0) {
-        double success_rate = ((double)(alloc_attempts - alloc_failures) / alloc_attempts) * 100.0;
+    if (stats.alloc_attempts > 0) {
+        double success_rate = ((double)(stats.alloc_attempts - stats.alloc_failures) / stats.alloc_attempts) * 100.0;
         std::cout << "Allocation Success Rate: " << success_rate << "% (" 
-                  << (alloc_attempts - alloc_failures) << "/" << alloc_attempts << ")\n";
+                  << (stats.alloc_attempts - stats.alloc_failures) << "/" << stats.alloc_attempts << ")\n";
     } else {
         std::cout << "Allocation Success Rate: N/A\n";
     }
+
+    // Slab utilization: live requested bytes over slab bytes, per size class in use
+    if (is_slab_mode || slab_allocator.hasObjects()) {
+        auto lock = lockHeap();
+        std::cout << "Slab Classes:  size  slabs(partial/full/empty)  objects  utilization  released\n";
+        for (size_t cls = 0; cls < slab_allocator.numClasses(); ++cls) {
+            const SlabClassStats& c = slab_allocator.getClassStats(cls);
+            if (c.slabs_created == 0) continue;
+            std::string slabs = std::to_string(c.slabs[SlabAllocator::PARTIAL]) + "/" +
+                                std::to_string(c.slabs[SlabAllocator::FULL]) + "/" +
+                                std::to_string(c.slabs[SlabAllocator::EMPTY]);
+            std::string objects = std::to_string(c.live_objects) + "/" + std::to_string(c.capacity());
+            std::cout << std::setfill(' ') << std::setw(19) << c.object_size << std::setw(27) << slabs << std::setw(9) << objects
+                      << std::setw(12) << std::fixed << std::setprecision(2) << c.utilization() * 100.0 << "%"
+                      << std::setw(10) << c.slabs_released << "\n";
+        }
+    }
 }
@@ -1,39 +1,204 @@
 #include "../../include/AllocatorStrategies.h"
-#include <limits>
+#include "../buddy/BuddyUtils.h"
+#include <algorithm>
+#include <functional>
+
+namespace {
+
+// erases exactly this block from a multimap index (keys are only unique for non-empty blocks)
+template <typename Index, typename Key>
+void eraseBlock(Index& index, const Key& key, Block* block) {
+    auto range = index.equal_range(key);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == block) {
+            index.erase(it);
+            return;
+        }
+    }
+}
+
+} // namespace
 
 // First Fit
-Block* FirstFit::findFreeBlock(Block* head, size_t size) {
-    Block* current = head;
-    while (current) {
-        if (current->is_free && current->size >= size) {
-            return current;
+FirstFit::FirstFit() : rng_state(0x9E3779B9u) {
+    clear();
+}
+
+bool FirstFit::before(const Block* a, const Block* b) {
+    if (a->start_address != b->start_address) return a->start_address < b->start_address;
+    if (a->size != b->size) return a->size < b->size;
+    return std::less<const Block*>()(a, b);
+}
+
+uint32_t FirstFit::nextPriority() {
+    // xorshift32: fixed seed, so runs stay reproducible
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+void FirstFit::update(int n) {
+    Node& node = nodes[n];
+    node.max_size = node.block->size;
+    if (node.left >= 0) node.max_size = std::max(node.max_size, nodes[node.left].max_size);
+    if (node.right >= 0) node.max_size = std::max(node.max_size, nodes[node.right].max_size);
+}
+
+void FirstFit::split(int n, const Block* key, int& left, int& right) {
+    if (n < 0) {
+        left = right = -1;
+        return;
+    }
+    if (before(nodes[n].block, key)) {
+        split(nodes[n].right, key, nodes[n].right, right);
+        left = n;
+    } else {
+        split(nodes[n].left, key, left, nodes[n].left);
+        right = n;
+    }
+    update(n);
+}
+
+int FirstFit::merge(int left, int right) {
+    if (left < 0) return right;
+    if (right < 0) return left;
+    if (nodes[left].priority > nodes[right].priority) {
+        nodes[left].right = merge(nodes[left].right, right);
+        update(left);
+        return left;
+    }
+    nodes[right].left = merge(left, nodes[right].left);
+    update(right);
+    return right;
+}
+
+int FirstFit::insert(int n, int item) {
+    if (n < 0) return item;
+    if (nodes[item].priority > nodes[n].priority) {
+        split(n, nodes[item].block, nodes[item].left, nodes[item].right);
+        update(item);
+        return item;
+    }
+    if (before(nodes[item].block, nodes[n].block)) {
+        nodes[n].left = insert(nodes[n].left, item);
+    } else {
+        nodes[n].right = insert(nodes[n].right, item);
+    }
+    update(n);
+    return n;
+}
+
+int FirstFit::erase(int n, const Block* block) {
+    if (n < 0) return -1;
+    if (nodes[n].block == block) {
+        free_nodes.push_back(n);
+        return merge(nodes[n].left, nodes[n].right);
+    }
+    if (before(block, nodes[n].block)) {
+        nodes[n].left = erase(nodes[n].left, block);
+    } else {
+        nodes[n].right = erase(nodes[n].right, block);
+    }
+    update(n);
+    return n;
+}
+
+Block* FirstFit::lowestFit(int n, size_t size) const {
+    if (n < 0 || nodes[n].max_size < size) return nullptr;
+
+    // invariant: the subtree at n holds a fit; prefer the left (lower addresses) while it does
+    while (true) {
+        const Node& node = nodes[n];
+        if (node.left >= 0 && nodes[node.left].max_size >= size) {
+            n = node.left;
+        } else if (node.block->size >= size) {
+            return node.block;
+        } else {
+            n = node.right;
+        }
+    }
+}
+
+Block* FirstFit::findFreeBlock(size_t size) {
+    int cls = floorLog2(size);
+    Block* first = nullptr;
+
+    // any block in a higher class fits; the lowest-addressed one wins
+    uint64_t higher = (cls + 1 < NUM_BINS) ? (non_empty_bins & (~0ULL << (cls + 1))) : 0;
+    while (higher) {
+        int bin = countTrailingZeros(higher);
+        higher &= higher - 1;
+        if (!first || lowest[bin]->start_address < first->start_address) {
+            first = lowest[bin];
         }
-        current = current->next;
     }
-    return nullptr;
+
+    // blocks in the request's own class may be too small
+    Block* own = lowestFit(roots[cls], size);
+    if (own && (!first || own->start_address < first->start_address)) first = own;
+    return first;
+}
+
+void FirstFit::addFreeBlock(Block* block) {
+    int cls = floorLog2(block->size);
+    int item;
+    if (!free_nodes.empty()) {
+        item = free_nodes.back();
+        free_nodes.pop_back();
+    } else {
+        item = (int)nodes.size();
+        nodes.emplace_back();
+    }
+    nodes[item] = {block, block->size, nextPriority(), -1, -1};
+    roots[cls] = insert(roots[cls], item);
+    if (!lowest[cls] || before(block, lowest[cls])) lowest[cls] = block;
+    non_empty_bins |= (1ULL << cls);
+}
+
+void FirstFit::removeFreeBlock(Block* block) {
+    int cls = floorLog2(block->size);
+    roots[cls] = erase(roots[cls], block);
+    if (lowest[cls] == block) {
+        int n = roots[cls];
+        while (n >= 0 && nodes[n].left >= 0) n = nodes[n].left;
+        lowest[cls] = (n >= 0) ? nodes[n].block : nullptr;
+    }
+    if (roots[cls] < 0) non_empty_bins &= ~(1ULL << cls);
+}
+
+void FirstFit::clear() {
+    nodes.clear();
+    free_nodes.clear();
+    for (int i = 0; i < NUM_BINS; ++i) {
+        roots[i] = -1;
+        lowest[i] = nullptr;
+    }
+    non_empty_bins = 0;
 }
 
 std::string FirstFit::getName() const { 
     return "First Fit"; 
 }
 
+// Size-ordered index (Best Fit / Worst Fit)
+void SizeOrderedAllocator::addFreeBlock(Block* block) {
+    free_by_size.emplace(std::make_pair(block->size, block->start_address), block);
+}
+
+void SizeOrderedAllocator::removeFreeBlock(Block* block) {
+    eraseBlock(free_by_size, std::make_pair(block->size, block->start_address), block);
+}
+
+void SizeOrderedAllocator::clear() {
+    free_by_size.clear();
+}
+
 // Best Fit
-Block* BestFit::findFreeBlock(Block* head, size_t size) {
-    Block* best = nullptr;
-    size_t min_diff = std::numeric_limits<size_t>::max();
-
-    Block* current = head;
-    while (current) {
-        if (current->is_free && current->size >= size) {
-            size_t diff = current->size - size;
-            if (diff < min_diff) {
-                min_diff = diff;
-                best = current;
-            }
-        }
-        current = current->next;
-    }
-    return best;
+Block* BestFit::findFreeBlock(size_t size) {
+    // smallest size >= request, lowest address among equal sizes
+    auto it = free_by_size.lower_bound(std::make_pair(size, (size_t)0));
+    return (it != free_by_size.end()) ? it->second : nullptr;
 }
 
 std::string BestFit::getName() const { 
@@ -41,23 +206,98 @@ std::string BestFit::getName() const {
 }
 
 // Worst Fit
-Block* WorstFit::findFreeBlock(Block* head, size_t size) {
-    Block* worst = nullptr;
-    size_t max_size = 0;
-
-    Block* current = head;
-    while (current) {
-        if (current->is_free && current->size >= size) {
-            if (current->size > max_size) {
-                max_size = current->size;
-                worst = current;
-            }
-        }
-        current = current->next;
-    }
-    return worst;
+Block* WorstFit::findFreeBlock(size_t size) {
+    if (free_by_size.empty()) return nullptr;
+
+    size_t max_size = free_by_size.rbegin()->first.first;
+    // a zero-sized block never wins (the original scan required size > 0)
+    if (max_size < size || max_size == 0) return nullptr;
+
+    // lowest address among the largest blocks
+    return free_by_size.lower_bound(std::make_pair(max_size, (size_t)0))->second;
 }
 
 std::string WorstFit::getName() const { 
     return "Worst Fit"; 
 }
+
+// TLSF
+TLSF::TLSF() {
+    clear();
+}
+
+void TLSF::mapping(size_t size, int& fl, int& sl) {
+    if (size < (size_t)SL_COUNT) {
+        fl = 0;
+        sl = (int)size;
+        return;
+    }
+    int log2 = floorLog2(size);
+    fl = log2 - SL_LOG2 + 1;
+    sl = (int)((size >> (log2 - SL_LOG2)) ^ (size_t)SL_COUNT);
+}
+
+Block* TLSF::findFreeBlock(size_t size) {
+    int fl, sl;
+    size_t rounded = size;
+    if (size >= (size_t)SL_COUNT) {
+        size_t step = (size_t)1 << (floorLog2(size) - SL_LOG2);
+        if (size + (step - 1) >= size) rounded = size + (step - 1);
+    }
+    mapping(rounded, fl, sl);
+
+    uint32_t sl_map = (sl < SL_COUNT) ? sl_bitmap[fl] & (~0U << sl) : 0;
+    if (!sl_map) {
+        uint64_t fl_map = (fl + 1 < 64) ? fl_bitmap & (~0ULL << (fl + 1)) : 0;
+        if (fl_map) {
+            fl = countTrailingZeros(fl_map);
+            sl_map = sl_bitmap[fl];
+        }
+    }
+    if (sl_map) return heads[fl][countTrailingZeros(sl_map)];
+
+    // nothing larger: the head of the request's own list may still fit (one check keeps this O(1))
+    mapping(size, fl, sl);
+    Block* head = heads[fl][sl];
+    return (head && head->size >= size) ? head : nullptr;
+}
+
+void TLSF::addFreeBlock(Block* block) {
+    int fl, sl;
+    mapping(block->size, fl, sl);
+    block->free_prev = nullptr;
+    block->free_next = heads[fl][sl];
+    if (block->free_next) block->free_next->free_prev = block;
+    heads[fl][sl] = block;
+    fl_bitmap |= 1ULL << fl;
+    sl_bitmap[fl] |= 1U << sl;
+}
+
+void TLSF::removeFreeBlock(Block* block) {
+    int fl, sl;
+    mapping(block->size, fl, sl);
+    if (block->free_prev) {
+        block->free_prev->free_next = block->free_next;
+    } else {
+        heads[fl][sl] = block->free_next;
+    }
+    if (block->free_next) block->free_next->free_prev = block->free_prev;
+    block->free_next = block->free_prev = nullptr;
+
+    if (!heads[fl][sl]) {
+        sl_bitmap[fl] &= ~(1U << sl);
+        if (!sl_bitmap[fl]) fl_bitmap &= ~(1ULL << fl);
+    }
+}
+
+void TLSF::clear() {
+    fl_bitmap = 0;
+    for (int fl = 0; fl < FL_COUNT; ++fl) {
+        sl_bitmap[fl] = 0;
+        for (int sl = 0; sl < SL_COUNT; ++sl) heads[fl][sl] = nullptr;
+    }
+}
+
+std::string TLSF::getName() const {
+    return "TLSF";
+}
@@ -0,0 +1,229 @@
+#include "../../include/ConcurrentHeap.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+const size_t MAX_CLASS_SIZE = 32768; // keeps the class count well inside the 7-bit id map entry
+const size_t MAP_CHUNK_SIZE = (size_t)1 << 16;
+
+} // namespace
+
+ConcurrentHeap::ConcurrentHeap(MemoryManager& _heap, const ConcurrentHeapConfig& _config)
+    : heap(_heap), config(_config), central_contention(0), heap_refills(0), returned_to_heap(0)
+{
+    config.max_cached_size = std::min(std::max(config.max_cached_size, GRANULE), MAX_CLASS_SIZE);
+    config.transfer_batch = std::max<size_t>(config.transfer_batch, 1);
+    config.thread_cache_blocks = std::max(config.thread_cache_blocks, config.transfer_batch);
+    config.central_blocks = std::max(config.central_blocks, config.transfer_batch);
+
+    // 16-byte steps up to 128, then four classes per doubling (at most 25% rounding waste)
+    for (size_t size = GRANULE; size <= 128 && size <= config.max_cached_size; size += GRANULE) {
+        class_sizes.push_back(size);
+    }
+    for (size_t base = 128; base < config.max_cached_size; base *= 2) {
+        for (size_t step = 1; step <= 4 && base + step * (base / 4) <= config.max_cached_size; ++step) {
+            class_sizes.push_back(base + step * (base / 4));
+        }
+    }
+    if (class_sizes.back() < config.max_cached_size) class_sizes.push_back(config.max_cached_size);
+
+    class_of_granule.resize(config.max_cached_size / GRANULE + 1);
+    size_t cls = 0;
+    for (size_t g = 0; g < class_of_granule.size(); ++g) {
+        while (class_sizes[cls] < g * GRANULE) cls++;
+        class_of_granule[g] = (uint8_t)cls;
+    }
+
+    central.reset(new CentralList[class_sizes.size()]);
+    id_map.reset(new std::atomic<std::atomic<uint8_t>*>[MAP_CHUNKS]);
+    for (size_t i = 0; i < MAP_CHUNKS; ++i) id_map[i].store(nullptr, std::memory_order_relaxed);
+}
+
+ConcurrentHeap::~ConcurrentHeap() {
+    for (size_t i = 0; i < MAP_CHUNKS; ++i) delete[] id_map[i].load(std::memory_order_relaxed);
+}
+
+std::atomic<uint8_t>* ConcurrentHeap::mapEntry(int id, bool create) {
+    size_t key = (size_t)id;
+    std::atomic<std::atomic<uint8_t>*>& slot = id_map[key >> MAP_CHUNK_BITS];
+    std::atomic<uint8_t>* chunk = slot.load(std::memory_order_acquire);
+    if (!chunk) {
+        if (!create) return nullptr;
+        std::lock_guard<std::mutex> lock(map_mutex);
+        chunk = slot.load(std::memory_order_relaxed);
+        if (!chunk) {
+            chunk = new std::atomic<uint8_t>[MAP_CHUNK_SIZE]();
+            slot.store(chunk, std::memory_order_release);
+        }
+    }
+    return &chunk[key & (MAP_CHUNK_SIZE - 1)];
+}
+
+std::unique_lock<std::mutex> ConcurrentHeap::lockCentral(size_t cls) {
+    std::unique_lock<std::mutex> lock(central[cls].mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        central_contention.fetch_add(1, std::memory_order_relaxed);
+        lock.lock();
+    }
+    return lock;
+}
+
+size_t ConcurrentHeap::fetch(size_t cls, std::vector<int>& out, bool& from_heap) {
+    from_heap = false;
+    {
+        auto lock = lockCentral(cls);
+        std::vector<int>& blocks = central[cls].blocks;
+        size_t n = std::min(blocks.size(), config.transfer_batch);
+        if (n > 0) {
+            out.insert(out.end(), blocks.end() - n, blocks.end());
+            blocks.resize(blocks.size() - n);
+            return n;
+        }
+    }
+
+    // central list empty: carve a batch from the heap (one heap lock per batch, outside the class lock)
+    from_heap = true;
+    heap_refills.fetch_add(1, std::memory_order_relaxed);
+    size_t first = out.size();
+    size_t n = heap.mallocBatch(class_sizes[cls], config.transfer_batch, out);
+    for (size_t i = first; i < out.size(); ++i) {
+        mapEntry(out[i], true)->store((uint8_t)(cls + 1), std::memory_order_relaxed);
+    }
+    return n;
+}
+
+void ConcurrentHeap::release(size_t cls, std::vector<int>& ids, size_t first) {
+    std::vector<int> surplus;
+    {
+        auto lock = lockCentral(cls);
+        std::vector<int>& blocks = central[cls].blocks;
+        blocks.insert(blocks.end(), ids.begin() + first, ids.end());
+        // keep half the cap so a steady free/malloc pattern does not bounce blocks through the heap
+        if (blocks.size() > config.central_blocks) {
+            size_t keep = config.central_blocks / 2;
+            surplus.assign(blocks.begin() + keep, blocks.end());
+            blocks.resize(keep);
+        }
+    }
+    ids.resize(first);
+
+    if (surplus.empty()) return;
+    for (int id : surplus) mapEntry(id, false)->store(0, std::memory_order_relaxed);
+    heap.freeBatch(surplus);
+    returned_to_heap.fetch_add(surplus.size(), std::memory_order_relaxed);
+}
+
+void ConcurrentHeap::mergeStats(const ConcurrentHeapStats& local) {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    totals.mallocs += local.mallocs;
+    totals.frees += local.frees;
+    totals.failures += local.failures;
+    totals.thread_cache_hits += local.thread_cache_hits;
+    totals.central_hits += local.central_hits;
+    totals.large_allocs += local.large_allocs;
+    totals.invalid_frees += local.invalid_frees;
+}
+
+ConcurrentHeapStats ConcurrentHeap::getStats() {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    ConcurrentHeapStats stats = totals;
+    stats.heap_refills = heap_refills.load(std::memory_order_relaxed);
+    stats.returned_to_heap = returned_to_heap.load(std::memory_order_relaxed);
+    stats.central_contention = central_contention.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ConcurrentHeap::printStats() {
+    ConcurrentHeapStats stats = getStats();
+    size_t cached = 0;
+    for (size_t cls = 0; cls < class_sizes.size(); ++cls) {
+        auto lock = lockCentral(cls);
+        cached += central[cls].blocks.size();
+    }
+    double hit_rate = stats.mallocs ? 100.0 * stats.thread_cache_hits / stats.mallocs : 0.0;
+
+    std::cout << "Concurrent Heap Statistics:\n"
+              << "  Size Classes:        " << class_sizes.size() << " (up to " << config.max_cached_size << " bytes)\n"
+              << "  Mallocs / Frees:     " << stats.mallocs << " / " << stats.frees
+              << " (" << stats.failures << " failed, " << stats.large_allocs << " large)\n"
+              << "  Thread Cache Hits:   " << stats.thread_cache_hits << " (" << std::fixed << std::setprecision(2)
+              << hit_rate << "%)\n"
+              << "  Central Refills:     " << stats.central_hits << "\n"
+              << "  Heap Refills:        " << stats.heap_refills << "\n"
+              << "  Returned to Heap:    " << stats.returned_to_heap << "\n"
+              << "  Central Cached:      " << cached << " blocks\n"
+              << "  Lock Contention:     central " << stats.central_contention
+              << ", heap " << heap.getLockContention() << "\n"
+              << "  Invalid Frees:       " << stats.invalid_frees << "\n";
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+ThreadCache::ThreadCache(ConcurrentHeap& _owner) : owner(_owner), lists(_owner.numClasses()) {}
+
+ThreadCache::~ThreadCache() {
+    flush();
+}
+
+int ThreadCache::malloc(size_t size) {
+    local.mallocs++;
+    if (size > owner.config.max_cached_size) {
+        local.large_allocs++;
+        int id = owner.heap.my_malloc(size);
+        if (id < 0) local.failures++;
+        return id;
+    }
+
+    size_t cls = owner.classOf(size);
+    std::vector<int>& list = lists[cls];
+    if (list.empty()) {
+        bool from_heap;
+        if (owner.fetch(cls, list, from_heap) == 0) {
+            local.failures++;
+            return -1;
+        }
+        if (!from_heap) local.central_hits++;
+    } else {
+        local.thread_cache_hits++;
+    }
+
+    int id = list.back();
+    list.pop_back();
+    owner.mapEntry(id, false)->store((uint8_t)((cls + 1) | ConcurrentHeap::LIVE), std::memory_order_relaxed);
+    return id;
+}
+
+bool ThreadCache::free(int block_id) {
+    std::atomic<uint8_t>* entry = block_id > 0 ? owner.mapEntry(block_id, false) : nullptr;
+    uint8_t state = entry ? entry->load(std::memory_order_relaxed) : 0;
+    if (state == 0) {
+        // large (or unknown) block: the heap validates the id
+        local.frees++;
+        return owner.heap.my_free(block_id);
+    }
+
+    uint8_t before = entry->fetch_and((uint8_t)~ConcurrentHeap::LIVE, std::memory_order_relaxed);
+    if (!(before & ConcurrentHeap::LIVE)) {
+        local.invalid_frees++;
+        std::cerr << "Error: Block ID " << block_id << " not found or already free." << std::endl;
+        return false;
+    }
+    local.frees++;
+
+    size_t cls = (before & ~ConcurrentHeap::LIVE) - 1;
+    std::vector<int>& list = lists[cls];
+    list.push_back(block_id);
+    if (list.size() > owner.config.thread_cache_blocks) {
+        owner.release(cls, list, list.size() - owner.config.transfer_batch);
+    }
+    return true;
+}
+
+void ThreadCache::flush() {
+    for (size_t cls = 0; cls < lists.size(); ++cls) {
+        if (!lists[cls].empty()) owner.release(cls, lists[cls], 0);
+    }
+    owner.mergeStats(local);
+    local = ConcurrentHeapStats();
+}
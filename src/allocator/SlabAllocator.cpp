@@ -0,0 +1,144 @@
+#include "../../include/SlabAllocator.h"
+#include "../buddy/BuddyUtils.h"
+#include <algorithm>
+
+namespace {
+
+// kmalloc-style classes: powers of two plus 96 and 192
+const size_t CLASS_SIZES[] = {8, 16, 32, 64, 96, 128, 192, 256, 512, 1024};
+
+} // namespace
+
+SlabAllocator::SlabAllocator() {
+    for (size_t size : CLASS_SIZES) {
+        SlabClass c = {};
+        c.stats.object_size = size;
+        c.stats.objects_per_slab = std::min(MAX_SLOTS, std::max<size_t>(8, TARGET_SLAB_BYTES / size));
+        classes.push_back(c);
+    }
+}
+
+SlabAllocator::~SlabAllocator() {
+    reset();
+}
+
+void SlabAllocator::reset() {
+    for (auto& entry : slabs) delete entry.second;
+    slabs.clear();
+    objects.clear();
+    for (SlabClass& c : classes) {
+        SlabClassStats fresh = {};
+        fresh.object_size = c.stats.object_size;
+        fresh.objects_per_slab = c.stats.objects_per_slab;
+        c.stats = fresh;
+        c.lists[PARTIAL] = c.lists[FULL] = c.lists[EMPTY] = nullptr;
+    }
+}
+
+size_t SlabAllocator::classOf(size_t size) const {
+    size_t cls = 0;
+    while (classes[cls].stats.object_size < size) cls++;
+    return cls;
+}
+
+size_t SlabAllocator::slabBytes(size_t cls) const {
+    return classes[cls].stats.object_size * classes[cls].stats.objects_per_slab;
+}
+
+void SlabAllocator::link(Slab* slab, int list) {
+    SlabClass& c = classes[slab->cls];
+    slab->state = list;
+    slab->prev = nullptr;
+    slab->next = c.lists[list];
+    if (slab->next) slab->next->prev = slab;
+    c.lists[list] = slab;
+    c.stats.slabs[list]++;
+}
+
+void SlabAllocator::unlink(Slab* slab) {
+    SlabClass& c = classes[slab->cls];
+    if (slab->prev) {
+        slab->prev->next = slab->next;
+    } else {
+        c.lists[slab->state] = slab->next;
+    }
+    if (slab->next) slab->next->prev = slab->prev;
+    c.stats.slabs[slab->state]--;
+}
+
+Slab* SlabAllocator::findSlab(size_t cls) const {
+    const SlabClass& c = classes[cls];
+    return c.lists[PARTIAL] ? c.lists[PARTIAL] : c.lists[EMPTY];
+}
+
+Slab* SlabAllocator::addSlab(size_t cls, Block* block) {
+    Slab* slab = new Slab{block, cls, 0, 0, EMPTY, nullptr, nullptr};
+    slabs[block] = slab;
+    link(slab, EMPTY);
+    classes[cls].stats.slabs_created++;
+    return slab;
+}
+
+size_t SlabAllocator::allocate(Slab* slab, int id, size_t requested_size) {
+    SlabClassStats& stats = classes[slab->cls].stats;
+    uint32_t slot = (uint32_t)countTrailingZeros(~slab->used_mask);
+    slab->used_mask |= 1ULL << slot;
+
+    unlink(slab);
+    slab->used++;
+    link(slab, slab->used == stats.objects_per_slab ? FULL : PARTIAL);
+
+    objects[id] = SlabObject{slab, slot, requested_size};
+    stats.live_objects++;
+    stats.requested_bytes += requested_size;
+    // the backing block carries the live bytes, so heap-wide internal fragmentation covers empty slots
+    slab->block->requested_size += requested_size;
+    return slab->block->start_address + slot * stats.object_size;
+}
+
+bool SlabAllocator::free(int id, Block*& released, bool retain_empty) {
+    released = nullptr;
+    auto it = objects.find(id);
+    if (it == objects.end()) return false;
+
+    Slab* slab = it->second.slab;
+    SlabClass& c = classes[slab->cls];
+    slab->used_mask &= ~(1ULL << it->second.slot);
+    slab->block->requested_size -= it->second.requested_size;
+    c.stats.live_objects--;
+    c.stats.requested_bytes -= it->second.requested_size;
+    objects.erase(it);
+
+    unlink(slab);
+    slab->used--;
+    if (slab->used > 0) {
+        link(slab, PARTIAL);
+    } else if (retain_empty && c.stats.slabs[EMPTY] < MAX_EMPTY_SLABS) {
+        link(slab, EMPTY);
+    } else {
+        released = slab->block;
+        slabs.erase(slab->block);
+        c.stats.slabs_released++;
+        delete slab;
+    }
+    return true;
+}
+
+std::vector<Block*> SlabAllocator::releaseEmptySlabs() {
+    std::vector<Block*> blocks;
+    for (SlabClass& c : classes) {
+        while (Slab* slab = c.lists[EMPTY]) {
+            unlink(slab);
+            blocks.push_back(slab->block);
+            slabs.erase(slab->block);
+            c.stats.slabs_released++;
+            delete slab;
+        }
+    }
+    return blocks;
+}
+
+size_t SlabAllocator::objectSizeOf(const Block* block) const {
+    auto it = slabs.find(block);
+    return it == slabs.end() ? 0 : classes[it->second->cls].stats.object_size;
+}
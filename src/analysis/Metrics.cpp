@@ -0,0 +1,238 @@
+#include "../../include/Metrics.h"
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+std::string levelKey(size_t level) {
+    return "l" + std::to_string(level + 1);
+}
+
+std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+// counters restart when the component is reset or replaced
+size_t delta(size_t now, size_t before) {
+    return now >= before ? now - before : now;
+}
+
+void writeRate(std::ostream& out, size_t part, size_t total) {
+    out << ',';
+    if (total > 0) out << std::fixed << std::setprecision(4) << (double)part / total;
+}
+
+} // namespace
+
+void MetricSet::add(const std::string& name, unsigned long long value) {
+    values.emplace_back(name, std::to_string(value));
+}
+
+void MetricSet::add(const std::string& name, double value) {
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(6) << value;
+    values.emplace_back(name, text.str());
+}
+
+void MetricSet::add(const std::string& name, const std::string& value) {
+    values.emplace_back(name, "\"" + jsonEscape(value) + "\"");
+}
+
+void MetricSet::writeJSON(std::ostream& out) const {
+    out << "{\n";
+    for (size_t i = 0; i < values.size(); ++i) {
+        out << "  \"" << jsonEscape(values[i].first) << "\": " << values[i].second
+            << (i + 1 < values.size() ? ",\n" : "\n");
+    }
+    out << "}\n";
+}
+
+void MetricSet::writeCSV(std::ostream& out) const {
+    out << "metric,value\n";
+    for (const auto& value : values) {
+        // string values are already quoted, which is valid CSV as long as they contain no quotes
+        out << value.first << ',' << value.second << '\n';
+    }
+}
+
+void collectMetrics(const MemoryManager& heap, MetricSet& out) {
+    HeapStats stats = heap.getHeapStats();
+    out.add("heap.total_memory", (unsigned long long)stats.total_memory);
+    out.add("heap.used_memory", (unsigned long long)stats.used_memory);
+    out.add("heap.requested_memory", (unsigned long long)stats.requested_memory);
+    out.add("heap.free_memory", (unsigned long long)stats.free_memory);
+    out.add("heap.free_blocks", (unsigned long long)stats.free_blocks);
+    out.add("heap.largest_free_block", (unsigned long long)stats.largest_free_block);
+    out.add("heap.internal_fragmentation_bytes", (unsigned long long)stats.internalFragmentation());
+    out.add("heap.external_fragmentation", stats.externalFragmentation());
+    out.add("heap.alloc_attempts", (unsigned long long)stats.alloc_attempts);
+    out.add("heap.alloc_failures", (unsigned long long)stats.alloc_failures);
+}
+
+void collectMetrics(const CacheHierarchy& caches, MetricSet& out) {
+    out.add("cache.levels", (unsigned long long)caches.numLevels());
+    out.add("cache.inclusion", std::string(inclusionPolicyName(caches.getInclusion())));
+    for (size_t i = 0; i < caches.numLevels(); ++i) {
+        const CacheLevel& level = caches.getLevel(i);
+        const std::string prefix = "cache." + levelKey(i) + ".";
+        size_t total = level.getHits() + level.getMisses();
+        out.add(prefix + "size", (unsigned long long)level.getSize());
+        out.add(prefix + "block_size", (unsigned long long)level.getBlockSize());
+        out.add(prefix + "associativity", (unsigned long long)level.getAssociativity());
+        out.add(prefix + "hits", (unsigned long long)level.getHits());
+        out.add(prefix + "misses", (unsigned long long)level.getMisses());
+        out.add(prefix + "hit_rate", total ? (double)level.getHits() / total : 0.0);
+        out.add(prefix + "writebacks", (unsigned long long)level.getWritebacks());
+        out.add(prefix + "bytes_in", (unsigned long long)level.getBytesFromBelow());
+        out.add(prefix + "bytes_out", (unsigned long long)level.getBytesToBelow());
+        out.add(prefix + "served", (unsigned long long)caches.getServedBy(i));
+        if (level.getPrefetcher()) {
+            out.add(prefix + "prefetcher", level.getPrefetcher()->getName());
+            out.add(prefix + "prefetches_issued", (unsigned long long)level.getPrefetchesIssued());
+            out.add(prefix + "prefetches_useful", (unsigned long long)level.getPrefetchesUseful());
+            out.add(prefix + "prefetches_useless", (unsigned long long)level.getPrefetchesUseless());
+            out.add(prefix + "pollution_misses", (unsigned long long)level.getPollutionMisses());
+        }
+    }
+    out.add("cache.memory.served", (unsigned long long)caches.getServedBy(caches.numLevels()));
+    out.add("cache.memory.reads", (unsigned long long)caches.getMemoryReads());
+    out.add("cache.memory.writes", (unsigned long long)caches.getMemoryWrites());
+    out.add("cache.back_invalidations", (unsigned long long)caches.getBackInvalidations());
+}
+
+void collectMetrics(const VirtualMemoryManager& vm, MetricSet& out) {
+    size_t translations = vm.getPageHits() + vm.getPageFaults();
+    out.add("vm.physical_memory", (unsigned long long)vm.getPhysicalMemorySize());
+    out.add("vm.page_size", (unsigned long long)vm.getPageSize());
+    out.add("vm.policy", vm.getReplacementPolicyType());
+    out.add("vm.page_table_levels", (unsigned long long)vm.getLevels());
+    out.add("vm.page_hits", (unsigned long long)vm.getPageHits());
+    out.add("vm.page_faults", (unsigned long long)vm.getPageFaults());
+    out.add("vm.fault_rate", translations ? (double)vm.getPageFaults() / translations : 0.0);
+    out.add("vm.disk_writes", (unsigned long long)vm.getDiskWrites());
+    out.add("vm.walk_references", (unsigned long long)vm.getWalkReferences());
+    const TLB* tlb = vm.getTLB();
+    if (tlb) {
+        out.add("vm.tlb.l1.hits", (unsigned long long)tlb->getL1().getHits());
+        out.add("vm.tlb.l1.misses", (unsigned long long)tlb->getL1().getMisses());
+        out.add("vm.tlb.l2.hits", (unsigned long long)tlb->getL2().getHits());
+        out.add("vm.tlb.l2.misses", (unsigned long long)tlb->getL2().getMisses());
+    }
+}
+
+void collectMetrics(const TimingModel& timing, const CacheHierarchy& caches, const VirtualMemoryManager* vm, MetricSet& out) {
+    out.add("timing.total_cycles", timing.totalCycles(caches, vm));
+    out.add("timing.memory_cycles", timing.memoryCycles(caches));
+    out.add("timing.amat", timing.amat(caches, vm));
+}
+
+bool exportMetrics(const MetricSet& metrics, const std::string& format, const std::string& path) {
+    if (format != "json" && format != "csv") {
+        std::cerr << "Error: Unknown metrics format " << format << " (json, csv)" << std::endl;
+        return false;
+    }
+
+    std::ofstream file;
+    bool to_stdout = path.empty() || path == "-";
+    if (!to_stdout) {
+        file.open(path);
+        if (!file) {
+            std::cerr << "Error: Cannot write metrics file " << path << std::endl;
+            return false;
+        }
+    }
+    std::ostream& out = to_stdout ? std::cout : file;
+    if (format == "json") {
+        metrics.writeJSON(out);
+    } else {
+        metrics.writeCSV(out);
+    }
+    return true;
+}
+
+IntervalSampler::IntervalSampler()
+    : interval(0), num_levels(0), events(0), next_sample(0), last_faults(0), last_translations(0) {}
+
+IntervalSampler::~IntervalSampler() {
+    if (out.is_open()) out.close();
+}
+
+bool IntervalSampler::open(const std::string& path, size_t _interval, const CacheHierarchy& caches, const VirtualMemoryManager* vm) {
+    if (_interval == 0) {
+        std::cerr << "Error: Sampling interval must be at least 1" << std::endl;
+        return false;
+    }
+    if (out.is_open()) out.close();
+    out.open(path);
+    if (!out) {
+        std::cerr << "Error: Cannot write samples file " << path << std::endl;
+        return false;
+    }
+
+    interval = _interval;
+    num_levels = caches.numLevels();
+    events = 0;
+    next_sample = interval;
+    last_hits.assign(num_levels, 0);
+    last_misses.assign(num_levels, 0);
+    for (size_t i = 0; i < num_levels; ++i) {
+        last_hits[i] = caches.getLevel(i).getHits();
+        last_misses[i] = caches.getLevel(i).getMisses();
+    }
+    last_faults = vm ? vm->getPageFaults() : 0;
+    last_translations = vm ? vm->getPageHits() + vm->getPageFaults() : 0;
+
+    out << "events";
+    for (size_t i = 0; i < num_levels; ++i) out << "," << levelKey(i) << "_hit_rate";
+    out << ",fault_rate,fragmentation,free_blocks\n";
+    return true;
+}
+
+void IntervalSampler::writeRow(const CacheHierarchy* caches, const VirtualMemoryManager* vm, const MemoryManager* heap) {
+    out << events;
+
+    for (size_t i = 0; i < num_levels; ++i) {
+        if (caches && i < caches->numLevels()) {
+            const CacheLevel& level = caches->getLevel(i);
+            size_t hits = delta(level.getHits(), last_hits[i]);
+            size_t misses = delta(level.getMisses(), last_misses[i]);
+            writeRate(out, hits, hits + misses);
+            last_hits[i] = level.getHits();
+            last_misses[i] = level.getMisses();
+        } else {
+            out << ',';
+        }
+    }
+
+    if (vm) {
+        size_t translations = vm->getPageHits() + vm->getPageFaults();
+        writeRate(out, delta(vm->getPageFaults(), last_faults), delta(translations, last_translations));
+        last_faults = vm->getPageFaults();
+        last_translations = translations;
+    } else {
+        out << ',';
+    }
+
+    HeapStats stats = {};
+    if (heap) stats = heap->getHeapStats();
+    if (heap && stats.total_memory > 0) {
+        out << ',' << std::fixed << std::setprecision(4) << stats.externalFragmentation() << ',' << stats.free_blocks;
+    } else {
+        out << ",,";
+    }
+    out << '\n';
+
+    next_sample = events + interval;
+}
+
+void IntervalSampler::close(const CacheHierarchy* caches, const VirtualMemoryManager* vm, const MemoryManager* heap) {
+    if (!out.is_open()) return;
+    if (events + interval > next_sample) writeRow(caches, vm, heap);
+    out.close();
+}
@@ -0,0 +1,220 @@
+#include "../../include/OptimalAnalyzer.h"
+#include "../../include/PageReplacementPolicies.h"
+#include "../../include/TraceReplay.h"
+#include "../buddy/BuddyUtils.h"
+#include <algorithm>
+#include <iomanip>
+#include <memory>
+#include <unordered_map>
+
+namespace {
+
+const unsigned long long NEVER_USED = ~0ULL;
+
+std::string policyName(ReplacementPolicy policy) {
+    switch (policy) {
+        case ReplacementPolicy::FIFO: return "FIFO";
+        case ReplacementPolicy::LRU: return "LRU";
+        case ReplacementPolicy::OPT: return "OPT";
+    }
+    return "?";
+}
+
+// 64-bit offsets: std::fseek takes a long, which is 32 bits on Windows (next-use files pass 2 GB
+// at 2^28 records)
+bool seekTo(FILE* file, size_t record) {
+    unsigned long long offset = (unsigned long long)record * sizeof(unsigned long long);
+#ifdef _WIN32
+    return _fseeki64(file, (long long)offset, SEEK_SET) == 0;
+#else
+    return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+void printGap(const std::string& label, const std::string& policy, size_t configured, size_t optimal, const char* unit) {
+    double over = (optimal > 0) ? ((double)configured - optimal) / optimal * 100.0 : 0.0;
+    std::cout << "  " << label << "\n"
+              << "    " << std::setw(22) << std::left << (policy + " " + unit + ":") << configured << "\n"
+              << "    " << std::setw(22) << std::left << (std::string("OPT ") + unit + ":") << optimal << "\n"
+              << std::right
+              << "    Gap:                  " << (configured - optimal) << " (+" << std::fixed << std::setprecision(2)
+              << over << "% over OPT)\n";
+}
+
+} // namespace
+
+NextUseIndex::NextUseIndex() : addresses(nullptr), length(0) {}
+
+NextUseIndex::~NextUseIndex() {
+    close();
+}
+
+void NextUseIndex::close() {
+    if (addresses) std::fclose(addresses);
+    addresses = nullptr;
+    for (FILE* f : next_uses) {
+        if (f) std::fclose(f);
+    }
+    next_uses.clear();
+    length = 0;
+}
+
+bool NextUseIndex::build(const std::string& trace_path, const std::vector<unsigned>& _shifts) {
+    close();
+    shifts = _shifts;
+
+    TraceReader reader(trace_path);
+    if (!reader.isOpen()) {
+        std::cerr << "Error: Cannot open trace file " << trace_path << std::endl;
+        return false;
+    }
+
+    // pass 1: text -> binary, so the trace can be read backwards
+    addresses = std::tmpfile();
+    if (!addresses) {
+        std::cerr << "Error: Cannot create temporary file for OPT analysis." << std::endl;
+        return false;
+    }
+    std::vector<unsigned long long> chunk(CHUNK);
+    size_t n;
+    while ((n = reader.readBatch(chunk.data(), chunk.size())) > 0) {
+        std::fwrite(chunk.data(), sizeof(unsigned long long), n, addresses);
+        length += n;
+    }
+
+    for (size_t s = 0; s < shifts.size(); ++s) {
+        FILE* f = std::tmpfile();
+        if (!f) {
+            std::cerr << "Error: Cannot create temporary file for OPT analysis." << std::endl;
+            return false;
+        }
+        next_uses.push_back(f);
+    }
+
+    // pass 2: backwards, chunk by chunk; last_use holds one entry per distinct block
+    std::vector<std::unordered_map<unsigned long long, unsigned long long>> last_use(shifts.size());
+    std::vector<unsigned long long> next(CHUNK);
+    size_t end = length;
+    while (end > 0) {
+        size_t start = (end > CHUNK) ? end - CHUNK : 0;
+        size_t count = end - start;
+        readAddresses(start, count, chunk.data());
+
+        for (size_t s = 0; s < shifts.size(); ++s) {
+            auto& seen = last_use[s];
+            for (size_t i = count; i-- > 0;) {
+                unsigned long long key = chunk[i] >> shifts[s];
+                unsigned long long pos = start + i;
+                auto it = seen.find(key);
+                if (it == seen.end()) {
+                    next[i] = NEVER_USED;
+                    seen.emplace(key, pos);
+                } else {
+                    next[i] = it->second;
+                    it->second = pos;
+                }
+            }
+            if (!seekTo(next_uses[s], start)
+                || std::fwrite(next.data(), sizeof(unsigned long long), count, next_uses[s]) != count) {
+                std::cerr << "Error: Cannot write the OPT next-use file." << std::endl;
+                return false;
+            }
+        }
+        end = start;
+    }
+
+    if (reader.getMalformedLines() > 0) {
+        std::cerr << "Warning: Skipped " << reader.getMalformedLines() << " malformed trace lines." << std::endl;
+    }
+    return true;
+}
+
+void NextUseIndex::readAddresses(size_t start, size_t count, unsigned long long* out) const {
+    size_t got = seekTo(addresses, start) ? std::fread(out, sizeof(unsigned long long), count, addresses) : 0;
+    std::fill(out + got, out + count, 0ULL);
+}
+
+void NextUseIndex::readNextUses(size_t stream, size_t start, size_t count, unsigned long long* out) const {
+    size_t got = seekTo(next_uses[stream], start) ? std::fread(out, sizeof(unsigned long long), count, next_uses[stream]) : 0;
+    std::fill(out + got, out + count, NEVER_USED);
+}
+
+OptimalAnalyzer::OptimalAnalyzer(const std::vector<const CacheLevel*>& _caches, const VirtualMemoryManager* _vm)
+    : caches(_caches), vm(_vm) {}
+
+bool OptimalAnalyzer::run(const std::string& trace_path) {
+    // one next-use stream per distinct granularity (block sizes and the page size often coincide)
+    std::vector<unsigned> shifts;
+    auto streamFor = [&shifts](size_t granularity) {
+        unsigned shift = floorLog2(granularity);
+        auto it = std::find(shifts.begin(), shifts.end(), shift);
+        if (it != shifts.end()) return (size_t)(it - shifts.begin());
+        shifts.push_back(shift);
+        return shifts.size() - 1;
+    };
+
+    // configured copy + OPT twin of every level, fed the full trace independently
+    std::vector<std::unique_ptr<CacheLevel>> configured, optimal;
+    std::vector<size_t> cache_stream;
+    for (const CacheLevel* level : caches) {
+        configured.push_back(std::make_unique<CacheLevel>(level->getName(), level->getSize(), level->getBlockSize(),
+                                                          level->getAssociativity(), level->getPolicy()));
+        optimal.push_back(std::make_unique<CacheLevel>(level->getName(), level->getSize(), level->getBlockSize(),
+                                                       level->getAssociativity(), ReplacementPolicy::OPT));
+        cache_stream.push_back(streamFor(level->getBlockSize()));
+    }
+
+    std::unique_ptr<VirtualMemoryManager> vm_configured, vm_optimal;
+    size_t page_stream = 0;
+    if (vm) {
+        vm_configured = std::make_unique<VirtualMemoryManager>(vm->getPhysicalMemorySize(), vm->getPageSize(), vm->getLevels(), false);
+        vm_optimal = std::make_unique<VirtualMemoryManager>(vm->getPhysicalMemorySize(), vm->getPageSize(), vm->getLevels(), false);
+        vm_configured->setReplacementPolicy(vm->getReplacementPolicyType());
+        vm_optimal->setReplacementPolicy(std::make_unique<OptimalPolicy>(), "opt");
+        page_stream = streamFor(vm->getPageSize());
+    }
+
+    NextUseIndex index;
+    if (!index.build(trace_path, shifts)) return false;
+
+    std::vector<unsigned long long> addrs(NextUseIndex::CHUNK);
+    std::vector<std::vector<unsigned long long>> next(shifts.size(), std::vector<unsigned long long>(NextUseIndex::CHUNK));
+
+    for (size_t start = 0; start < index.size(); start += NextUseIndex::CHUNK) {
+        size_t count = std::min(NextUseIndex::CHUNK, index.size() - start);
+        index.readAddresses(start, count, addrs.data());
+        for (size_t s = 0; s < shifts.size(); ++s) {
+            index.readNextUses(s, start, count, next[s].data());
+        }
+
+        for (size_t l = 0; l < configured.size(); ++l) {
+            CacheLevel& cfg = *configured[l];
+            CacheLevel& opt = *optimal[l];
+            const unsigned long long* nu = next[cache_stream[l]].data();
+            for (size_t i = 0; i < count; ++i) {
+                cfg.access(addrs[i]);
+                opt.setNextUse(nu[i]);
+                opt.access(addrs[i]);
+            }
+        }
+        if (vm) {
+            const unsigned long long* nu = next[page_stream].data();
+            for (size_t i = 0; i < count; ++i) {
+                vm_configured->translate(addrs[i]);
+                vm_optimal->setNextUse(nu[i]);
+                vm_optimal->translate(addrs[i]);
+            }
+        }
+    }
+
+    std::cout << "OPT Analysis (" << index.size() << " references):\n";
+    for (size_t l = 0; l < configured.size(); ++l) {
+        printGap("[" + configured[l]->getName() + "] standalone, full trace",
+                 policyName(configured[l]->getPolicy()), configured[l]->getMisses(), optimal[l]->getMisses(), "misses");
+    }
+    if (vm) {
+        printGap("[Virtual Memory] " + std::to_string(vm->getPhysicalMemorySize() / vm->getPageSize()) + " frames",
+                 vm->getReplacementPolicyType(), vm_configured->getPageFaults(), vm_optimal->getPageFaults(), "faults");
+    }
+    return true;
+}
@@ -0,0 +1,165 @@
+#include "../../include/StackDistance.h"
+#include "../../include/TraceReplay.h"
+#include "../buddy/BuddyUtils.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+const size_t MIN_SLOTS = 1 << 10;
+
+} // namespace
+
+StackDistanceCounter::StackDistanceCounter() : tree(MIN_SLOTS + 1, 0), now(1), live(0) {}
+
+void StackDistanceCounter::add(size_t slot, int delta) {
+    for (; slot < tree.size(); slot += slot & (~slot + 1)) {
+        tree[slot] += delta;
+    }
+}
+
+size_t StackDistanceCounter::prefix(size_t slot) const {
+    size_t sum = 0;
+    for (; slot > 0; slot -= slot & (~slot + 1)) {
+        sum += tree[slot];
+    }
+    return sum;
+}
+
+void StackDistanceCounter::compact() {
+    // renumber the live blocks 1..live in access order; leave as many free slots as live ones
+    std::vector<std::pair<size_t, unsigned long long>> order;
+    order.reserve(last_use.size());
+    for (const auto& entry : last_use) {
+        order.emplace_back(entry.second, entry.first);
+    }
+    std::sort(order.begin(), order.end());
+
+    size_t slots = std::max(MIN_SLOTS, 2 * order.size());
+    tree.assign(slots + 1, 0);
+    for (size_t i = 0; i < order.size(); ++i) {
+        last_use[order[i].second] = i + 1;
+        tree[i + 1] = 1;
+    }
+    // linear Fenwick build: push every node's partial sum into its parent
+    for (size_t slot = 1; slot <= slots; ++slot) {
+        size_t parent = slot + (slot & (~slot + 1));
+        if (parent <= slots) tree[parent] += tree[slot];
+    }
+    now = order.size() + 1;
+}
+
+size_t StackDistanceCounter::access(unsigned long long block) {
+    if (now == tree.size()) compact();
+
+    size_t distance = COLD;
+    auto it = last_use.find(block);
+    if (it == last_use.end()) {
+        last_use.emplace(block, now);
+        live++;
+    } else {
+        size_t prev = it->second;
+        distance = live - prefix(prev);
+        add(prev, -1);
+        it->second = now;
+    }
+    add(now, 1);
+    now++;
+    return distance;
+}
+
+StackDistanceAnalyzer::StackDistanceAnalyzer(size_t _block_size, size_t max_sets)
+    : block_size(_block_size), references(0)
+{
+    block_shift = floorLog2(block_size);
+    max_sets = std::min(std::max<size_t>(max_sets, 1), MAX_SETS);
+    for (size_t sets = 1; sets <= max_sets; sets <<= 1) {
+        set_counts.push_back(sets);
+    }
+    stacks.resize(set_counts.size());
+    for (size_t c = 0; c < set_counts.size(); ++c) {
+        stacks[c].resize(set_counts[c]);
+    }
+    histograms.resize(set_counts.size());
+    cold_misses.assign(set_counts.size(), 0);
+}
+
+void StackDistanceAnalyzer::processBatch(const unsigned long long* addresses, size_t count) {
+    for (size_t c = 0; c < set_counts.size(); ++c) {
+        std::vector<std::unique_ptr<StackDistanceCounter>>& sets = stacks[c];
+        std::vector<size_t>& histogram = histograms[c];
+        unsigned long long set_mask = set_counts[c] - 1;
+
+        for (size_t i = 0; i < count; ++i) {
+            unsigned long long block = addresses[i] >> block_shift;
+            std::unique_ptr<StackDistanceCounter>& stack = sets[block & set_mask];
+            if (!stack) stack = std::make_unique<StackDistanceCounter>();
+            size_t distance = stack->access(block);
+            if (distance == StackDistanceCounter::COLD) {
+                cold_misses[c]++;
+                continue;
+            }
+            if (distance >= histogram.size()) histogram.resize(distance + 1, 0);
+            histogram[distance]++;
+        }
+    }
+    references += count;
+}
+
+bool StackDistanceAnalyzer::run(const std::string& path) {
+    TraceReader reader(path);
+    if (!reader.isOpen()) {
+        std::cerr << "Error: Cannot open trace file " << path << std::endl;
+        return false;
+    }
+
+    std::vector<unsigned long long> batch(TraceReplayer::BATCH_SIZE);
+    size_t n;
+    while ((n = reader.readBatch(batch.data(), batch.size())) > 0) {
+        processBatch(batch.data(), n);
+    }
+
+    if (reader.getMalformedLines() > 0) {
+        std::cerr << "Warning: Skipped " << reader.getMalformedLines() << " malformed trace lines." << std::endl;
+    }
+    return true;
+}
+
+size_t StackDistanceAnalyzer::misses(size_t sets, size_t ways) const {
+    auto it = std::find(set_counts.begin(), set_counts.end(), sets);
+    if (it == set_counts.end()) return 0;
+    size_t c = it - set_counts.begin();
+
+    size_t total = cold_misses[c];
+    for (size_t d = ways; d < histograms[c].size(); ++d) {
+        total += histograms[c][d];
+    }
+    return total;
+}
+
+void StackDistanceAnalyzer::printCurve() const {
+    std::cout << "# LRU miss-ratio curve: " << references << " references, block size " << block_size << "\n"
+              << "# " << std::setw(12) << "size" << std::setw(8) << "sets" << std::setw(8) << "ways"
+              << std::setw(14) << "misses" << std::setw(12) << "miss_ratio" << "\n";
+
+    for (size_t c = 0; c < set_counts.size(); ++c) {
+        const std::vector<size_t>& histogram = histograms[c];
+
+        // suffix sums over the histogram give the misses of every associativity
+        size_t max_ways = 1;
+        while (max_ways < histogram.size()) max_ways <<= 1;
+        std::vector<size_t> at_least(histogram.size() + 1, 0);
+        for (size_t d = histogram.size(); d-- > 0;) {
+            at_least[d] = at_least[d + 1] + histogram[d];
+        }
+
+        for (size_t ways = 1; ways <= max_ways; ways <<= 1) {
+            size_t m = cold_misses[c] + (ways < at_least.size() ? at_least[ways] : 0);
+            double ratio = references ? (double)m / references : 0.0;
+            std::cout << "  " << std::setw(12) << set_counts[c] * ways * block_size
+                      << std::setw(8) << set_counts[c] << std::setw(8) << ways
+                      << std::setw(14) << m << std::setw(12) << std::fixed << std::setprecision(6) << ratio << "\n";
+        }
+    }
+}
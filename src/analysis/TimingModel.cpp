@@ -0,0 +1,115 @@
+#include "../../include/TimingModel.h"
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+struct Component {
+    std::string name;
+    unsigned long long cycles;
+};
+
+size_t demandAccesses(const CacheHierarchy& caches) {
+    size_t total = 0;
+    for (size_t s = 0; s <= caches.numLevels(); ++s) total += caches.getServedBy(s);
+    return total;
+}
+
+// per-component cycles: one entry per cache level, memory, then translation costs (if vm)
+std::vector<Component> breakdown(const Latencies& lat, const CacheHierarchy& caches, const VirtualMemoryManager* vm) {
+    std::vector<Component> parts;
+    const size_t n = caches.numLevels();
+
+    // every access served at level s or below looked up level i <= s
+    size_t reaching = demandAccesses(caches);
+    for (size_t i = 0; i < n; ++i) {
+        parts.push_back({caches.getLevel(i).getName(), reaching * lat.cacheHit(i)});
+        reaching -= caches.getServedBy(i);
+    }
+    parts.push_back({"Main Memory", reaching * lat.memory});
+
+    if (vm) {
+        const TLB* tlb = vm->getTLB();
+        if (tlb) {
+            const TLBLevel& l1 = tlb->getL1();
+            parts.push_back({"L1 dTLB", (l1.getHits() + l1.getMisses()) * lat.tlb_l1});
+            parts.push_back({"L2 STLB", l1.getMisses() * lat.tlb_l2});
+        }
+        parts.push_back({"Page Walks", vm->getWalkReferences() * lat.walk_ref});
+        parts.push_back({"Page Faults (disk)", vm->getPageFaults() * lat.page_fault});
+        parts.push_back({"Disk Writes", vm->getDiskWrites() * lat.disk_write});
+    }
+    return parts;
+}
+
+} // namespace
+
+bool TimingModel::set(const std::string& component, unsigned long long cycles) {
+    if (component.size() > 1 && component[0] == 'l' && component.find_first_not_of("0123456789", 1) == std::string::npos) {
+        // stops accumulating once past the cap, so long digit strings cannot overflow
+        size_t level = 0;
+        for (size_t i = 1; i < component.size() && level <= MAX_CACHE_LEVELS; ++i) level = level * 10 + (component[i] - '0');
+        if (level == 0 || level > MAX_CACHE_LEVELS) return false;
+        while (latencies.cache_hit.size() < level) latencies.cache_hit.push_back(Latencies::DEFAULT_LOWER_HIT);
+        latencies.cache_hit[level - 1] = cycles;
+    } else if (component == "memory") {
+        latencies.memory = cycles;
+    } else if (component == "tlb") {
+        latencies.tlb_l1 = cycles;
+    } else if (component == "stlb") {
+        latencies.tlb_l2 = cycles;
+    } else if (component == "walk") {
+        latencies.walk_ref = cycles;
+    } else if (component == "fault") {
+        latencies.page_fault = cycles;
+    } else if (component == "diskwrite") {
+        latencies.disk_write = cycles;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+unsigned long long TimingModel::memoryCycles(const CacheHierarchy& caches) const {
+    unsigned long long total = 0;
+    for (const Component& c : breakdown(latencies, caches, nullptr)) total += c.cycles;
+    return total;
+}
+
+unsigned long long TimingModel::totalCycles(const CacheHierarchy& caches, const VirtualMemoryManager* vm) const {
+    unsigned long long total = 0;
+    for (const Component& c : breakdown(latencies, caches, vm)) total += c.cycles;
+    return total;
+}
+
+double TimingModel::amat(const CacheHierarchy& caches, const VirtualMemoryManager* vm) const {
+    size_t accesses = demandAccesses(caches);
+    return accesses ? (double)totalCycles(caches, vm) / accesses : 0.0;
+}
+
+void TimingModel::printReport(const CacheHierarchy& caches, const VirtualMemoryManager* vm) const {
+    const size_t accesses = demandAccesses(caches);
+    const std::vector<Component> parts = breakdown(latencies, caches, vm);
+    unsigned long long total = 0;
+    for (const Component& c : parts) total += c.cycles;
+    unsigned long long memory = memoryCycles(caches);
+
+    std::cout << "[Timing] Latencies (cycles):";
+    for (size_t i = 0; i < caches.numLevels(); ++i) std::cout << " L" << i + 1 << " " << latencies.cacheHit(i) << ",";
+    std::cout << " memory " << latencies.memory;
+    if (vm) {
+        std::cout << ", TLB " << latencies.tlb_l1 << "/" << latencies.tlb_l2 << ", walk ref " << latencies.walk_ref
+                  << ", fault " << latencies.page_fault << ", disk write " << latencies.disk_write;
+    }
+    std::cout << std::endl;
+
+    std::cout << "  Demand Accesses: " << accesses << "  Total Cycles: " << total << std::endl;
+    std::cout << "  AMAT: " << std::fixed << std::setprecision(2) << (accesses ? (double)total / accesses : 0.0)
+              << " cycles (caches + memory only: " << (accesses ? (double)memory / accesses : 0.0) << ")" << std::endl;
+    std::cout << "  Breakdown:" << std::endl;
+    for (const Component& c : parts) {
+        double share = total ? 100.0 * c.cycles / total : 0.0;
+        std::cout << "    " << std::left << std::setw(20) << c.name << std::right << std::setw(16) << c.cycles
+                  << std::setw(8) << std::setprecision(2) << share << "%" << std::endl;
+    }
+}
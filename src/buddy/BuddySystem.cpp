@@ -0,0 +1,69 @@
+#include "../../include/BuddySystem.h"
+#include "BuddyUtils.h"
+
+BuddySystem::BuddySystem() : max_order(0), non_empty_orders(0) {}
+
+void BuddySystem::reset(size_t total_size) {
+    for (auto& list : free_lists) list.clear();
+    non_empty_orders = 0;
+
+    max_order = floorLog2(nextPowerOf2(total_size));
+    free_map.assign(max_order + 1, std::vector<uint64_t>());
+    for (int k = 0; k <= max_order; ++k) {
+        size_t blocks = (size_t)1 << (max_order - k);
+        free_map[k].assign((blocks + 63) / 64, 0);
+    }
+}
+
+bool BuddySystem::isBuddyBlock(const Block* block) {
+    return isPowerOf2(block->size) && (block->start_address & (block->size - 1)) == 0;
+}
+
+bool BuddySystem::testBit(int order, size_t address) const {
+    size_t idx = address >> order;
+    return (free_map[order][idx / 64] >> (idx % 64)) & 1;
+}
+
+void BuddySystem::setBit(int order, size_t address, bool value) {
+    size_t idx = address >> order;
+    if (value) {
+        free_map[order][idx / 64] |= (1ULL << (idx % 64));
+    } else {
+        free_map[order][idx / 64] &= ~(1ULL << (idx % 64));
+    }
+}
+
+void BuddySystem::addFreeBlock(Block* block) {
+    int order = floorLog2(block->size);
+    free_lists[order].emplace(block->start_address, block);
+    non_empty_orders |= (1ULL << order);
+    setBit(order, block->start_address, true);
+}
+
+void BuddySystem::removeFreeBlock(Block* block) {
+    int order = floorLog2(block->size);
+    free_lists[order].erase(block->start_address);
+    if (free_lists[order].empty()) non_empty_orders &= ~(1ULL << order);
+    setBit(order, block->start_address, false);
+}
+
+Block* BuddySystem::findFreeBlock(size_t req_size) const {
+    int order = floorLog2(req_size);
+    if (order > max_order) return nullptr;
+
+    uint64_t candidates = non_empty_orders & (~0ULL << order);
+    if (!candidates) return nullptr;
+
+    return free_lists[countTrailingZeros(candidates)].begin()->second;
+}
+
+Block* BuddySystem::findFreeBuddy(Block* block) const {
+    int order = floorLog2(block->size);
+    if (order >= max_order) return nullptr; // the whole heap has no buddy
+
+    size_t buddy_address = block->start_address ^ block->size;
+    if (!testBit(order, buddy_address)) return nullptr;
+
+    Block* buddy = (buddy_address < block->start_address) ? block->prev : block->next;
+    return (buddy && buddy->start_address == buddy_address) ? buddy : nullptr;
+}
@@ -14,4 +14,26 @@ inline bool isPowerOf2(size_t n) {
     return n && !(n & (n - 1));
 }
 
+// floor(log2(n)), with floorLog2(0) == 0
+inline int floorLog2(unsigned long long n) {
+#if defined(__GNUC__) || defined(__clang__)
+    return n ? 63 - __builtin_clzll(n) : 0;
+#else
+    int r = 0;
+    while (n >>= 1) r++;
+    return r;
+#endif
+}
+
+// index of the lowest set bit; n must be non-zero
+inline int countTrailingZeros(unsigned long long n) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(n);
+#else
+    int r = 0;
+    while (!(n & 1)) { n >>= 1; r++; }
+    return r;
+#endif
+}
+
 #endif // MATH_UTILS_H
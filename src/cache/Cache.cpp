@@ -1,55 +1,347 @@
 #include "../../include/Cache.h"
-#include <cmath>
-#include <algorithm>
+#include "../buddy/BuddyUtils.h"
 #include <iomanip>
 
 CacheLevel::CacheLevel(std::string _name, size_t _size, size_t _block_size, size_t _associativity, ReplacementPolicy _policy)
-    : name(_name), size(_size), block_size(_block_size), associativity(_associativity), policy(_policy), hits(0), misses(0) 
+    : name(_name), size(_size), block_size(_block_size), associativity(_associativity), policy(_policy),
+      write_policy(WritePolicy::WRITE_BACK), write_allocate(true), clock(0), dirty_lines(0), track_evictions(false), next_use(NEVER_USED),
+      prefetched_lines(0), hits(0), misses(0), writebacks(0), unfetched_misses(0), forwarded_bytes(0),
+      prefetches_issued(0), prefetches_useful(0), prefetches_useless(0), pollution_misses(0), uncovered_misses(0)
 {
     num_lines = size / block_size;
     num_sets = num_lines / associativity;
-    sets.resize(num_sets);
-}
-
-bool CacheLevel::access(unsigned long long address) {
-    size_t set_index = (address / block_size) % num_sets;
-    unsigned long long tag = (address / block_size) / num_sets;
-
-    auto& set = sets[set_index];
-
-    // Check for Hit
-    for (auto it = set.lines.begin(); it != set.lines.end(); ++it) {
-        if (it->valid && it->tag == tag) {
-            hits++;
-            // if LRU, update usage by moving to back
-            if (policy == ReplacementPolicy::LRU) {
-                CacheLine line = *it;
-                set.lines.erase(it);
-                set.lines.push_back(line); // Most recently used at back
-            }
-            // if FIFO, hit doesn't change order
-            return true; 
+
+    pow2_geometry = isPowerOf2(block_size) && isPowerOf2(num_sets);
+    block_shift = floorLog2(block_size);
+    set_shift = floorLog2(num_sets);
+    set_mask = num_sets - 1;
+
+    tags.assign(num_sets * associativity, INVALID_TAG);
+    stamps.assign(num_sets * associativity, 0);
+    dirty.assign(num_sets * associativity, 0);
+}
+
+void CacheLevel::setWritePolicy(WritePolicy _write_policy, bool _write_allocate) {
+    write_policy = _write_policy;
+    write_allocate = _write_allocate;
+}
+
+void CacheLevel::setPrefetcher(std::unique_ptr<Prefetcher> _prefetcher) {
+    prefetcher = std::move(_prefetcher);
+    pending_prefetches.clear();
+    prefetched_lines = 0;
+    if (prefetcher) {
+        prefetched.assign(num_lines, 0);
+        pollution_filter.assign(num_lines, INVALID_TAG);
+    } else {
+        prefetched.clear();
+        pollution_filter.clear();
+    }
+}
+
+void CacheLevel::decode(unsigned long long address, size_t& set_index, unsigned long long& tag) const {
+    if (pow2_geometry) {
+        unsigned long long block = address >> block_shift;
+        set_index = block & set_mask;
+        tag = block >> set_shift;
+    } else {
+        set_index = (address / block_size) % num_sets;
+        tag = (address / block_size) / num_sets;
+    }
+}
+
+unsigned long long CacheLevel::blockAddress(size_t set_index, unsigned long long tag) const {
+    if (pow2_geometry) {
+        return ((tag << set_shift) | set_index) << block_shift;
+    }
+    return (tag * num_sets + set_index) * block_size;
+}
+
+size_t CacheLevel::victimWay(size_t base) const {
+    const unsigned long long* set_tags = &tags[base];
+    const unsigned long long* set_stamps = &stamps[base];
+
+    size_t victim = 0;
+    if (policy == ReplacementPolicy::OPT) {
+        // empty way first, otherwise the line whose next use is furthest away
+        for (size_t w = 0; w < associativity; ++w) {
+            if (set_tags[w] == INVALID_TAG) return w;
+            if (set_stamps[w] > set_stamps[victim]) victim = w;
         }
+        return victim;
     }
 
-    // misss
-    misses++;
-    
-    // insert new line
-    CacheLine new_line;
-    new_line.valid = true;
-    new_line.tag = tag;
+    // smallest stamp (oldest fill for FIFO, least recent use for LRU);
+    // empty ways have stamp 0 and are filled first
+    for (size_t w = 1; w < associativity; ++w) {
+        if (set_stamps[w] < set_stamps[victim]) victim = w;
+    }
+    return victim;
+}
+
+size_t CacheLevel::findLine(unsigned long long address) const {
+    size_t set_index;
+    unsigned long long tag;
+    decode(address, set_index, tag);
+
+    const size_t base = set_index * associativity;
+    for (size_t w = 0; w < associativity; ++w) {
+        if (tags[base + w] == tag) return base + w;
+    }
+    return num_lines;
+}
+
+void CacheLevel::evictLine(size_t line, size_t set_index) {
+    if (tags[line] == INVALID_TAG) return;
 
-    if (set.lines.size() >= associativity) {
-        // evict
-        // for both FIFO and LRU (with our list management), the victim is at the front
-        set.lines.pop_front();
+    if (prefetched_lines > 0 && prefetched[line]) {
+        prefetches_useless++;
+        prefetched[line] = 0;
+        prefetched_lines--;
     }
-    set.lines.push_back(new_line);
+    if (dirty[line]) {
+        requests.writeback = true;
+        writebacks++;
+        dirty_lines--;
+        dirty[line] = 0;
+    } else if (!track_evictions) {
+        return;
+    }
+    requests.evicted = track_evictions;
+    requests.victim_address = blockAddress(set_index, tags[line]);
+}
+
+bool CacheLevel::contains(unsigned long long address) const {
+    return findLine(address) != num_lines;
+}
+
+bool CacheLevel::invalidate(unsigned long long address, bool& was_dirty) {
+    size_t line = findLine(address);
+    was_dirty = false;
+    if (line == num_lines) return false;
+
+    if (dirty[line]) {
+        was_dirty = true;
+        dirty_lines--;
+        dirty[line] = 0;
+    }
+    if (prefetched_lines > 0 && prefetched[line]) {
+        prefetches_useless++;
+        prefetched[line] = 0;
+        prefetched_lines--;
+    }
+    tags[line] = INVALID_TAG;
+    stamps[line] = 0;
+    return true;
+}
+
+bool CacheLevel::extract(unsigned long long address, bool& was_dirty, bool demand) {
+    bool prefetched_hit = false;
+    if (prefetched_lines > 0 && demand) {
+        size_t line = findLine(address);
+        if (line != num_lines && prefetched[line]) {
+            prefetched_hit = true;
+            prefetches_useful++;
+            prefetched[line] = 0;
+            prefetched_lines--;
+        }
+    }
+
+    bool hit = invalidate(address, was_dirty);
+    if (hit) {
+        hits++;
+    } else {
+        // the block comes from memory, not through this level
+        misses++;
+        unfetched_misses++;
+    }
+    if (prefetcher && demand) trainPrefetcher(address, hit, prefetched_hit);
+    return hit;
+}
+
+void CacheLevel::insert(unsigned long long address, bool is_dirty) {
+    requests.writeback = false;
+    requests.evicted = false;
+    requests.fetch = false;
+    requests.write = false;
+
+    size_t line = findLine(address);
+    if (line == num_lines) {
+        size_t set_index;
+        unsigned long long tag;
+        decode(address, set_index, tag);
+
+        // OPT has no next-use hint for victim fills and treats them as never used again
+        const size_t base = set_index * associativity;
+        line = base + victimWay(base);
+        evictLine(line, set_index);
+        tags[line] = tag;
+        stamps[line] = (policy == ReplacementPolicy::OPT) ? NEVER_USED : ++clock;
+    }
+    if (is_dirty) markDirty(address);
+}
+
+void CacheLevel::markDirty(unsigned long long address) {
+    size_t line = findLine(address);
+    if (line == num_lines || dirty[line]) return;
+    if (write_policy == WritePolicy::WRITE_BACK) {
+        dirty[line] = 1;
+        dirty_lines++;
+    } else {
+        // write-through levels hold no dirty data: pass it on
+        requests.write = true;
+        requests.write_type = AccessType::WRITEBACK;
+        forwarded_bytes += block_size;
+    }
+}
+
+bool CacheLevel::clean(unsigned long long address) {
+    size_t line = findLine(address);
+    if (line == num_lines || !dirty[line]) return false;
+    dirty[line] = 0;
+    dirty_lines--;
+    writebacks++;
+    return true;
+}
+
+bool CacheLevel::access(unsigned long long address, AccessType type) {
+    requests.writeback = false;
+    requests.evicted = false;
+    requests.fetch = false;
+    requests.write = false;
+    const bool is_write = (type == AccessType::STORE || type == AccessType::WRITEBACK);
+
+    size_t set_index;
+    unsigned long long tag;
+    decode(address, set_index, tag);
+
+    const size_t base = set_index * associativity;
+    const unsigned long long* set_tags = &tags[base];
+    unsigned long long* set_stamps = &stamps[base];
+
+    // Check for Hit: compare every way without early exit (tags are unique within a set),
+    // which keeps the loop branch-free and vectorizable
+    size_t way = associativity;
+    for (size_t w = 0; w < associativity; ++w) {
+        way = (set_tags[w] == tag) ? w : way;
+    }
+
+    if (way != associativity) {
+        hits++;
+        // LRU refreshes recency on a hit; FIFO keeps the fill order
+        if (policy == ReplacementPolicy::LRU) {
+            set_stamps[way] = ++clock;
+        } else if (policy == ReplacementPolicy::OPT) {
+            set_stamps[way] = next_use;
+        }
+        if (is_write) write(base + way, type);
+        if (prefetcher) prefetcherHit(base + way, address, type);
+        return true; 
+    }
+
+    // a stream buffer holding the block turns the miss into a hit without a fetch
+    const bool demand = isDemandAccess(type);
+    const bool buffered = prefetcher && demand && prefetcher->takeBuffered(address - address % block_size);
+    if (buffered) {
+        hits++;
+        prefetches_useful++;
+    } else {
+        misses++;
+    }
+
+    if (is_write && !write_allocate && !buffered) {
+        requests.write = true;
+        requests.write_type = type;
+        forwarded_bytes += (type == AccessType::WRITEBACK) ? block_size : WORD_SIZE;
+        unfetched_misses++;
+        if (prefetcher && demand) trainPrefetcher(address, false, false);
+        return false;
+    }
+
+    const size_t victim = victimWay(base);
+    const unsigned long long stamp = (policy == ReplacementPolicy::OPT) ? next_use : ++clock;
+
+    // read-only workloads in a non-inclusive hierarchy never look at the victim
+    const size_t line = base + victim;
+    if (dirty_lines > 0 || track_evictions || prefetched_lines > 0) evictLine(line, set_index);
+
+    tags[line] = tag;
+    set_stamps[victim] = stamp;
+
+    // a written-back block arrives whole; everything else is read from below first
+    if (type == AccessType::WRITEBACK) {
+        unfetched_misses++;
+    } else if (!buffered) {
+        requests.fetch = true;
+    }
+    if (is_write) write(line, type);
+    if (prefetcher && demand) trainPrefetcher(address, buffered, buffered);
 
     return false;
 }
 
+void CacheLevel::prefetcherHit(size_t line, unsigned long long address, AccessType type) {
+    if (!isDemandAccess(type)) return;
+    bool prefetched_hit = prefetched_lines > 0 && prefetched[line];
+    if (prefetched_hit) {
+        prefetches_useful++;
+        prefetched[line] = 0;
+        prefetched_lines--;
+    }
+    trainPrefetcher(address, true, prefetched_hit);
+}
+
+size_t CacheLevel::pollutionSlot(unsigned long long block_address) const {
+    return (block_address / block_size) % pollution_filter.size();
+}
+
+void CacheLevel::trainPrefetcher(unsigned long long address, bool hit, bool prefetched_hit) {
+    const unsigned long long block_address = address - address % block_size;
+    if (!hit) {
+        uncovered_misses++;
+        unsigned long long& displaced = pollution_filter[pollutionSlot(block_address)];
+        if (displaced == block_address) {
+            pollution_misses++;
+            displaced = INVALID_TAG;
+        }
+    }
+    prefetcher->onAccess(block_address, hit, prefetched_hit, pending_prefetches);
+}
+
+bool CacheLevel::prefetch(unsigned long long address) {
+    requests.writeback = false;
+    requests.evicted = false;
+    requests.fetch = false;
+    requests.write = false;
+
+    if (findLine(address) != num_lines) return false;
+    prefetches_issued++;
+    requests.fetch = true;
+    if (!prefetcher->fillsCache()) return true; // held in the prefetcher's buffer
+
+    size_t set_index;
+    unsigned long long tag;
+    decode(address, set_index, tag);
+    const unsigned long long block_address = address - address % block_size;
+
+    const size_t base = set_index * associativity;
+    const size_t line = base + victimWay(base);
+    if (tags[line] != INVALID_TAG) {
+        // remembered so a later demand miss on the displaced block counts as pollution
+        unsigned long long victim = blockAddress(set_index, tags[line]);
+        pollution_filter[pollutionSlot(victim)] = victim;
+    }
+    unsigned long long& displaced = pollution_filter[pollutionSlot(block_address)];
+    if (displaced == block_address) displaced = INVALID_TAG;
+
+    evictLine(line, set_index);
+    tags[line] = tag;
+    stamps[line] = (policy == ReplacementPolicy::OPT) ? NEVER_USED : ++clock;
+    prefetched[line] = 1;
+    prefetched_lines++;
+    return true;
+}
+
 void CacheLevel::printStats() const {
     size_t total = hits + misses;
     double hit_rate = (total > 0) ? (double)hits / total * 100.0 : 0.0;
@@ -58,9 +350,33 @@ void CacheLevel::printStats() const {
               << ", Block: " << block_size << "B" << std::endl;
     std::cout << "  Hits: " << hits << "  Misses: " << misses 
               << "  Hit Rate: " << std::fixed << std::setprecision(2) << hit_rate << "%" << std::endl;
+    std::cout << "  Writes: " << (write_policy == WritePolicy::WRITE_BACK ? "write-back" : "write-through")
+              << ", " << (write_allocate ? "write-allocate" : "no-write-allocate")
+              << "  Dirty Writebacks: " << writebacks << std::endl;
+    std::cout << "  Traffic: " << getBytesFromBelow() << "B in, " << getBytesToBelow() << "B out" << std::endl;
+    if (prefetcher) {
+        // coverage: share of the demand misses (without prefetching) that prefetches removed
+        size_t useful = prefetches_useful;
+        double accuracy = prefetches_issued ? 100.0 * useful / prefetches_issued : 0.0;
+        double coverage = (useful + uncovered_misses) ? 100.0 * useful / (useful + uncovered_misses) : 0.0;
+        std::cout << "  Prefetch: " << prefetcher->getName() << " (degree " << prefetcher->getDegree()
+                  << ", distance " << prefetcher->getDistance() << ")  Issued: " << prefetches_issued
+                  << "  Useful: " << useful << "  Useless: " << getPrefetchesUseless() << std::endl;
+        std::cout << "  Accuracy: " << accuracy << "%  Coverage: " << coverage
+                  << "%  Pollution Misses: " << pollution_misses << std::endl;
+    }
 }
 
 void CacheLevel::resetStats() {
     hits = 0;
     misses = 0;
+    writebacks = 0;
+    unfetched_misses = 0;
+    forwarded_bytes = 0;
+    prefetches_issued = 0;
+    prefetches_useful = 0;
+    prefetches_useless = 0;
+    pollution_misses = 0;
+    uncovered_misses = 0;
+    if (prefetcher) prefetcher->resetStats();
 }
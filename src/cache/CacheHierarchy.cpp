@@ -0,0 +1,393 @@
+#include "../../include/CacheHierarchy.h"
+#include <fstream>
+#include <sstream>
+
+bool parseInclusionPolicy(const std::string& name, InclusionPolicy& policy) {
+    if (name == "nine") {
+        policy = InclusionPolicy::NINE;
+    } else if (name == "inclusive") {
+        policy = InclusionPolicy::INCLUSIVE;
+    } else if (name == "exclusive") {
+        policy = InclusionPolicy::EXCLUSIVE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* inclusionPolicyName(InclusionPolicy policy) {
+    switch (policy) {
+        case InclusionPolicy::NINE: return "non-inclusive";
+        case InclusionPolicy::INCLUSIVE: return "inclusive";
+        case InclusionPolicy::EXCLUSIVE: return "exclusive";
+    }
+    return "?";
+}
+
+CacheHierarchy::CacheHierarchy()
+    : inclusion(InclusionPolicy::NINE), prefetching(false), memory_reads(0), memory_writes(0), back_invalidations(0),
+      served_by(1, 0) {}
+
+void CacheHierarchy::initDefault() {
+    clear();
+    addLevel(1024, 64, 2, ReplacementPolicy::FIFO);
+    addLevel(4096, 64, 4, ReplacementPolicy::FIFO);
+}
+
+void CacheHierarchy::clear() {
+    levels.clear();
+    inclusion = InclusionPolicy::NINE;
+    prefetching = false;
+    resetStats();
+}
+
+bool CacheHierarchy::addLevel(size_t size, size_t block_size, size_t associativity, ReplacementPolicy policy,
+                              const std::string& name) {
+    if (block_size == 0 || associativity == 0 || size < block_size * associativity) {
+        std::cout << "Invalid cache geometry: size must hold at least one set of " << associativity
+                  << " blocks of " << block_size << "B." << std::endl;
+        return false;
+    }
+    if (inclusion == InclusionPolicy::EXCLUSIVE && !levels.empty() && levels[0]->getBlockSize() != block_size) {
+        std::cout << "Exclusive hierarchies need the same block size on every level." << std::endl;
+        return false;
+    }
+    if (inclusion == InclusionPolicy::INCLUSIVE) {
+        for (const auto& level : levels) {
+            if (level->getBlockSize() > block_size) {
+                std::cout << "Inclusive hierarchies need block sizes that do not shrink toward memory." << std::endl;
+                return false;
+            }
+        }
+    }
+
+    std::string level_name = name.empty() ? "L" + std::to_string(levels.size() + 1) + " Cache" : name;
+    levels.push_back(std::make_unique<CacheLevel>(level_name, size, block_size, associativity, policy));
+    served_by.assign(levels.size() + 1, 0);
+    applyInclusion();
+    return true;
+}
+
+bool CacheHierarchy::setInclusion(InclusionPolicy policy) {
+    if (policy == InclusionPolicy::EXCLUSIVE) {
+        for (const auto& level : levels) {
+            if (level->getBlockSize() != levels[0]->getBlockSize()) {
+                std::cout << "Exclusive hierarchies need the same block size on every level." << std::endl;
+                return false;
+            }
+            if (level->getPrefetcher() && !level->getPrefetcher()->fillsCache()) {
+                std::cout << "Stream buffers are not supported in exclusive hierarchies." << std::endl;
+                return false;
+            }
+        }
+    }
+    if (policy == InclusionPolicy::INCLUSIVE) {
+        // back-invalidation drops the upper lines inside an evicted lower block; an upper line
+        // larger than that block would also cover data the lower level never held
+        for (size_t i = 1; i < levels.size(); ++i) {
+            if (levels[i]->getBlockSize() < levels[i - 1]->getBlockSize()) {
+                std::cout << "Inclusive hierarchies need block sizes that do not shrink toward memory." << std::endl;
+                return false;
+            }
+        }
+    }
+    inclusion = policy;
+    applyInclusion();
+    return true;
+}
+
+bool CacheHierarchy::setPrefetcher(size_t level, const std::string& name, size_t degree, size_t distance) {
+    if (level >= levels.size()) return false;
+    std::unique_ptr<Prefetcher> prefetcher;
+    if (name != "none") {
+        prefetcher = createPrefetcher(name, levels[level]->getBlockSize(), degree, distance);
+        if (!prefetcher) {
+            std::cout << "Unknown prefetcher '" << name << "' (none, next_line, stride, stream; degree and distance >= 1)."
+                      << std::endl;
+            return false;
+        }
+    }
+    if (prefetcher && !prefetcher->fillsCache() && inclusion == InclusionPolicy::EXCLUSIVE) {
+        // a buffered copy would live beside the one level that owns the block
+        std::cout << "Stream buffers are not supported in exclusive hierarchies." << std::endl;
+        return false;
+    }
+    levels[level]->setPrefetcher(std::move(prefetcher));
+
+    prefetching = false;
+    for (const auto& l : levels) {
+        prefetching = prefetching || l->getPrefetcher() != nullptr;
+    }
+    return true;
+}
+
+void CacheHierarchy::applyInclusion() {
+    for (size_t i = 0; i < levels.size(); ++i) {
+        bool track = (inclusion == InclusionPolicy::EXCLUSIVE) || (inclusion == InclusionPolicy::INCLUSIVE && i > 0);
+        levels[i]->setTrackEvictions(track);
+    }
+}
+
+bool CacheHierarchy::loadConfig(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cout << "Error: Cannot open cache config " << path << std::endl;
+        return false;
+    }
+
+    CacheHierarchy loaded;
+    InclusionPolicy policy = InclusionPolicy::NINE;
+    std::string line;
+    size_t line_no = 0;
+    while (std::getline(in, line)) {
+        line_no++;
+        line = line.substr(0, line.find('#'));
+        std::stringstream ss(line);
+        std::string key;
+        if (!(ss >> key)) continue;
+
+        bool ok = false;
+        if (key == "level") {
+            size_t size, block_size, assoc;
+            if (ss >> size >> block_size >> assoc) {
+                ReplacementPolicy replacement = ReplacementPolicy::FIFO;
+                WritePolicy write_policy = WritePolicy::WRITE_BACK;
+                bool write_allocate = true;
+                std::string option;
+                ok = true;
+                while (ok && ss >> option) {
+                    if (option == "fifo") replacement = ReplacementPolicy::FIFO;
+                    else if (option == "lru") replacement = ReplacementPolicy::LRU;
+                    else if (option == "wb") write_policy = WritePolicy::WRITE_BACK;
+                    else if (option == "wt") write_policy = WritePolicy::WRITE_THROUGH;
+                    else if (option == "wa") write_allocate = true;
+                    else if (option == "nwa") write_allocate = false;
+                    else ok = false;
+                }
+                ok = ok && loaded.addLevel(size, block_size, assoc, replacement);
+                if (ok) loaded.levels.back()->setWritePolicy(write_policy, write_allocate);
+            }
+        } else if (key == "prefetch") {
+            std::string name;
+            size_t degree = 1, distance = 1;
+            if (ss >> name && !loaded.levels.empty()) {
+                ss >> degree >> distance;
+                ok = loaded.setPrefetcher(loaded.levels.size() - 1, name, degree, distance);
+            }
+        } else if (key == "inclusion") {
+            std::string name;
+            ok = (ss >> name) && parseInclusionPolicy(name, policy);
+        }
+        if (!ok) {
+            std::cout << "Error: " << path << ":" << line_no << ": invalid cache config '" << line << "'" << std::endl;
+            return false;
+        }
+    }
+    if (!loaded.setInclusion(policy)) return false;
+
+    levels = std::move(loaded.levels);
+    served_by.assign(levels.size() + 1, 0);
+    inclusion = loaded.inclusion;
+    prefetching = loaded.prefetching;
+    resetStats();
+    return true;
+}
+
+size_t CacheHierarchy::access(unsigned long long address, AccessType type) {
+    size_t level;
+    if (inclusion == InclusionPolicy::EXCLUSIVE && !levels.empty()) {
+        level = accessExclusive(address, type);
+    } else {
+        level = accessFrom(0, address, type);
+    }
+    if (prefetching) issuePrefetches();
+    if (isDemandAccess(type)) served_by[level]++;
+    return level;
+}
+
+void CacheHierarchy::handleVictim(size_t i, const LowerRequests& requests) {
+    bool victim_dirty = requests.writeback;
+    if (requests.evicted && inclusion == InclusionPolicy::INCLUSIVE) {
+        // newer data from an upper copy is written back with the victim
+        victim_dirty = backInvalidate(i, requests.victim_address) || victim_dirty;
+    }
+    if (victim_dirty) {
+        accessFrom(i + 1, requests.victim_address, AccessType::WRITEBACK);
+    }
+}
+
+size_t CacheHierarchy::accessFrom(size_t first, unsigned long long address, AccessType type) {
+    const size_t n = levels.size();
+    // the demand access walks down iteratively; writebacks and forwarded stores are side trips
+    for (size_t i = first; i < n; ++i) {
+        CacheLevel& level = *levels[i];
+        bool hit = level.access(address, type);
+        const LowerRequests& requests = level.lastRequests(); // only levels below are accessed from here on
+        if (hit && !requests.write) return i;
+
+        if (requests.writeback || requests.evicted) handleVictim(i, requests);
+        if (hit) {
+            // write-through hit: the store is served here and copied below
+            accessFrom(i + 1, address, requests.write_type);
+            return i;
+        }
+
+        if (requests.fetch) {
+            // write-allocate + write-through: the store goes below as well as the fill
+            if (requests.write) accessFrom(i + 1, address, requests.write_type);
+            if (type == AccessType::STORE) type = AccessType::LOAD;
+        } else if (requests.write) {
+            // not allocated here: the write itself continues down
+            type = requests.write_type;
+        } else {
+            return i; // written-back block absorbed by a write-back level
+        }
+    }
+
+    if (type == AccessType::STORE || type == AccessType::WRITEBACK) {
+        memory_writes++;
+    } else {
+        memory_reads++;
+    }
+    return n;
+}
+
+bool CacheHierarchy::backInvalidate(size_t level, unsigned long long block_address) {
+    const size_t span = levels[level]->getBlockSize();
+    bool dirty = false;
+    for (size_t upper = 0; upper < level; ++upper) {
+        // a lower block may cover several smaller upper blocks
+        const size_t step = levels[upper]->getBlockSize();
+        for (size_t offset = 0; offset < span; offset += step) {
+            bool was_dirty;
+            if (levels[upper]->invalidate(block_address + offset, was_dirty)) {
+                back_invalidations++;
+                dirty = dirty || was_dirty;
+            }
+        }
+    }
+    return dirty;
+}
+
+size_t CacheHierarchy::accessExclusive(unsigned long long address, AccessType type) {
+    const size_t n = levels.size();
+    CacheLevel& top = *levels[0];
+    bool hit = top.access(address, type);
+    LowerRequests requests = top.lastRequests(); // copied: markDirty below may update it
+
+    size_t served = 0;
+    if (!hit && requests.fetch) {
+        // the block moves up from the level holding it (or memory) into the top level only
+        served = n;
+        for (size_t j = 1; j < n; ++j) {
+            bool was_dirty;
+            if (levels[j]->extract(address, was_dirty)) {
+                served = j;
+                if (was_dirty) top.markDirty(address);
+                break;
+            }
+        }
+        if (served == n) memory_reads++;
+    }
+
+    if (requests.evicted) {
+        insertVictim(1, requests.victim_address, requests.writeback);
+    }
+    if (requests.write) {
+        size_t written = writeExclusive(1, address);
+        if (!hit && !requests.fetch) served = written;
+    }
+    return served;
+}
+
+void CacheHierarchy::insertVictim(size_t level, unsigned long long address, bool dirty) {
+    if (level == levels.size()) {
+        if (dirty) memory_writes++;
+        return;
+    }
+
+    CacheLevel& target = *levels[level];
+    target.insert(address, dirty);
+    const LowerRequests& requests = target.lastRequests();
+    if (requests.evicted) {
+        insertVictim(level + 1, requests.victim_address, requests.writeback);
+    }
+    // a write-through level passes dirty data on instead of keeping it
+    if (requests.write) writeExclusive(level + 1, address);
+}
+
+size_t CacheHierarchy::writeExclusive(size_t first, unsigned long long address) {
+    for (size_t j = first; j < levels.size(); ++j) {
+        if (levels[j]->contains(address)) {
+            levels[j]->access(address, AccessType::STORE);
+            if (levels[j]->lastRequests().write) return writeExclusive(j + 1, address);
+            return j;
+        }
+    }
+    memory_writes++;
+    return levels.size();
+}
+
+void CacheHierarchy::issuePrefetches() {
+    for (size_t i = 0; i < levels.size(); ++i) {
+        std::vector<unsigned long long>& pending = levels[i]->pendingPrefetches();
+        if (pending.empty()) continue;
+        // prefetch reads below never train prefetchers, so no new candidates appear meanwhile
+        prefetch_batch.swap(pending);
+        for (unsigned long long address : prefetch_batch) {
+            prefetchInto(i, address);
+        }
+        prefetch_batch.clear();
+    }
+}
+
+void CacheHierarchy::prefetchInto(size_t level, unsigned long long address) {
+    CacheLevel& target = *levels[level];
+
+    if (inclusion != InclusionPolicy::EXCLUSIVE) {
+        if (!target.prefetch(address)) return;
+        const LowerRequests& requests = target.lastRequests();
+        if (requests.writeback || requests.evicted) handleVictim(level, requests);
+        accessFrom(level + 1, address, AccessType::PREFETCH);
+        return;
+    }
+
+    // exclusive: only prefetch blocks not held anywhere above, and move them up from below
+    for (size_t j = 0; j < level; ++j) {
+        if (levels[j]->contains(address)) return;
+    }
+    if (!target.prefetch(address)) return;
+    LowerRequests requests = target.lastRequests();
+
+    bool found = false;
+    for (size_t j = level + 1; j < levels.size() && !found; ++j) {
+        bool was_dirty;
+        found = levels[j]->extract(address, was_dirty, false);
+        if (found && was_dirty) target.markDirty(address);
+    }
+    if (!found) memory_reads++;
+    if (requests.evicted) insertVictim(level + 1, requests.victim_address, requests.writeback);
+}
+
+void CacheHierarchy::printStats() const {
+    for (const auto& level : levels) {
+        level->printStats();
+    }
+    std::cout << "[Hierarchy] " << levels.size() << (levels.size() == 1 ? " level, " : " levels, ")
+              << inclusionPolicyName(inclusion) << std::endl;
+    std::cout << "  Memory Reads: " << memory_reads << "  Memory Writes: " << memory_writes;
+    if (inclusion == InclusionPolicy::INCLUSIVE) {
+        std::cout << "  Back-Invalidations: " << back_invalidations;
+    }
+    std::cout << std::endl;
+}
+
+void CacheHierarchy::resetStats() {
+    for (auto& level : levels) {
+        level->resetStats();
+    }
+    memory_reads = 0;
+    memory_writes = 0;
+    back_invalidations = 0;
+    served_by.assign(levels.size() + 1, 0);
+}
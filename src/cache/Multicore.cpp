@@ -0,0 +1,302 @@
+#include "../../include/Multicore.h"
+#include "../../include/TraceReplay.h"
+#include "../buddy/BuddyUtils.h"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+// "c0:+0,+8 c1:+16" : byte offsets of the words each core touched
+std::string wordList(const std::vector<uint64_t>& words, size_t word_size) {
+    std::ostringstream out;
+    bool first_core = true;
+    for (size_t c = 0; c < words.size(); ++c) {
+        if (!words[c]) continue;
+        out << (first_core ? "" : " ") << "c" << c << ":";
+        first_core = false;
+        bool first_word = true;
+        for (size_t w = 0; w < 64; ++w) {
+            if (!(words[c] >> w & 1)) continue;
+            out << (first_word ? "+" : ",+") << w * word_size;
+            first_word = false;
+        }
+    }
+    return first_core ? "-" : out.str();
+}
+
+} // namespace
+
+MulticoreSystem::MulticoreSystem() : num_cores(0), block_size(0) {}
+
+bool MulticoreSystem::init(size_t cores, size_t _block_size, size_t l1_size, size_t l1_assoc, size_t l2_size, size_t l2_assoc) {
+    if (cores == 0 || cores > MAX_CORES) {
+        std::cout << "Core count must be between 1 and " << MAX_CORES << "." << std::endl;
+        return false;
+    }
+    // word masks are 64 bits wide
+    if (!isPowerOf2(_block_size) || _block_size < CacheLevel::WORD_SIZE || _block_size > 64 * CacheLevel::WORD_SIZE) {
+        std::cout << "Block size must be a power of 2 between " << CacheLevel::WORD_SIZE << " and "
+                  << 64 * CacheLevel::WORD_SIZE << " bytes." << std::endl;
+        return false;
+    }
+    if (l1_assoc == 0 || l1_size < _block_size * l1_assoc || l2_assoc == 0 || l2_size < _block_size * l2_assoc) {
+        std::cout << "Invalid cache geometry: each cache must hold at least one full set." << std::endl;
+        return false;
+    }
+
+    num_cores = cores;
+    block_size = _block_size;
+    l1s.clear();
+    for (size_t c = 0; c < cores; ++c) {
+        l1s.push_back(std::make_unique<CacheLevel>("Core " + std::to_string(c) + " L1", l1_size, block_size, l1_assoc,
+                                                   ReplacementPolicy::LRU));
+        // every replaced line must leave the directory
+        l1s.back()->setTrackEvictions(true);
+    }
+    shared.clear();
+    shared.addLevel(l2_size, block_size, l2_assoc, ReplacementPolicy::LRU, "Shared L2");
+
+    directory.clear();
+    written_since_loss.clear();
+    lines.clear();
+    stats = CoherenceStats();
+    return true;
+}
+
+MulticoreSystem::LineReport& MulticoreSystem::report(unsigned long long block) {
+    LineReport& r = lines[block];
+    if (r.words_written.empty()) {
+        r.invalidations = 0;
+        r.true_sharing = 0;
+        r.false_sharing = 0;
+        r.words_written.assign(num_cores, 0);
+        r.words_read.assign(num_cores, 0);
+    }
+    return r;
+}
+
+void MulticoreSystem::invalidateCopy(size_t core, unsigned long long block, DirEntry& entry, CoherenceResult& result) {
+    const uint64_t bit = 1ULL << core;
+    bool was_dirty;
+    l1s[core]->invalidate(block, was_dirty);
+    if (was_dirty) {
+        shared.access(block, AccessType::WRITEBACK);
+        stats.flushes++;
+        result.flushed = true;
+    }
+    entry.sharers &= ~bit;
+    entry.lost |= bit;
+    result.invalidated |= bit;
+    stats.invalidations++;
+
+    std::vector<uint64_t>& written = written_since_loss[block];
+    if (written.empty()) written.assign(num_cores, 0);
+    written[core] = 0;
+    report(block).invalidations++;
+}
+
+void MulticoreSystem::evicted(size_t core, unsigned long long victim, bool dirty) {
+    if (dirty) shared.access(victim, AccessType::WRITEBACK);
+
+    auto it = directory.find(victim);
+    if (it == directory.end()) return;
+    DirEntry& entry = it->second;
+    entry.sharers &= ~(1ULL << core);
+    if (entry.sharers == 0) {
+        entry.exclusive = false;
+        if (entry.lost == 0) directory.erase(it);
+    }
+}
+
+CoherenceResult MulticoreSystem::access(size_t core, unsigned long long address, AccessType type) {
+    CoherenceResult result{0, 0, -1, false, CoherenceMiss::NONE};
+    stats.accesses++;
+
+    const unsigned long long block = address - address % block_size;
+    const uint64_t word_bit = 1ULL << ((address % block_size) / CacheLevel::WORD_SIZE);
+    const uint64_t bit = 1ULL << core;
+    const bool is_write = (type == AccessType::STORE);
+
+    DirEntry& entry = directory.emplace(block, DirEntry{0, 0, false}).first->second;
+    const bool present = entry.sharers & bit;
+
+    // classify the miss of a core that lost its copy to another core's store
+    if (!present && (entry.lost & bit)) {
+        std::vector<uint64_t>& written = written_since_loss[block];
+        bool true_sharing = written[core] & word_bit;
+        LineReport& r = report(block);
+        if (true_sharing) {
+            result.miss = CoherenceMiss::TRUE_SHARING;
+            stats.true_sharing_misses++;
+            r.true_sharing++;
+        } else {
+            result.miss = CoherenceMiss::FALSE_SHARING;
+            stats.false_sharing_misses++;
+            r.false_sharing++;
+        }
+        entry.lost &= ~bit;
+        written[core] = 0;
+        if (entry.lost == 0) written_since_loss.erase(block);
+    }
+
+    const uint64_t others = entry.sharers & ~bit;
+    if (is_write) {
+        // read-for-ownership or S -> M upgrade: every other copy goes
+        if (present && others) stats.upgrades++;
+        for (size_t k = 0; others >> k; ++k) {
+            if (others >> k & 1) invalidateCopy(k, block, entry, result);
+        }
+        entry.exclusive = true;
+        // remember what changed for the cores that lost the line
+        if (entry.lost & ~bit) {
+            std::vector<uint64_t>& written = written_since_loss[block];
+            for (size_t k = 0; k < num_cores; ++k) {
+                if ((entry.lost & ~bit) >> k & 1) written[k] |= word_bit;
+            }
+        }
+    } else if (!present) {
+        if (entry.exclusive && others) {
+            // the E/M holder supplies the line and drops to S; M data is written back on the way
+            size_t owner = 0;
+            while (!(others >> owner & 1)) ++owner;
+            if (l1s[owner]->clean(block)) {
+                shared.access(block, AccessType::WRITEBACK);
+                stats.flushes++;
+                result.flushed = true;
+            }
+            stats.downgrades++;
+            result.downgraded = (int)owner;
+        }
+        entry.exclusive = (others == 0);
+    }
+    entry.sharers |= bit;
+
+    auto line = lines.find(block);
+    if (line != lines.end()) {
+        (is_write ? line->second.words_written : line->second.words_read)[core] |= word_bit;
+    }
+
+    CacheLevel& l1 = *l1s[core];
+    bool hit = l1.access(address, type);
+    const LowerRequests& requests = l1.lastRequests();
+    if (requests.evicted) evicted(core, requests.victim_address, requests.writeback);
+    if (!hit) {
+        result.served = 1 + shared.access(block, type == AccessType::IFETCH ? AccessType::IFETCH : AccessType::LOAD);
+    }
+    return result;
+}
+
+bool MulticoreSystem::run(const std::vector<std::string>& paths) {
+    const size_t BATCH = 1 << 16;
+    std::vector<std::unique_ptr<TraceReader>> readers;
+    for (const std::string& path : paths) {
+        readers.push_back(std::make_unique<TraceReader>(path));
+        if (!readers.back()->isOpen()) {
+            std::cerr << "Error: Cannot open trace file " << path << std::endl;
+            return false;
+        }
+    }
+
+    std::vector<unsigned long long> addresses(BATCH);
+    std::vector<AccessType> types(BATCH);
+    size_t malformed = 0;
+    size_t out_of_range = 0;
+
+    if (readers.size() == 1) {
+        std::vector<unsigned> cores(BATCH);
+        size_t n;
+        while ((n = readers[0]->readBatch(addresses.data(), types.data(), cores.data(), BATCH)) > 0) {
+            for (size_t i = 0; i < n; ++i) {
+                if (cores[i] >= num_cores) {
+                    out_of_range++;
+                    continue;
+                }
+                access(cores[i], addresses[i], types[i]);
+            }
+        }
+    } else {
+        if (readers.size() > num_cores) {
+            std::cerr << "Error: " << readers.size() << " traces for " << num_cores << " cores" << std::endl;
+            return false;
+        }
+        // one small buffer per core, refilled as it drains
+        struct Stream {
+            std::vector<unsigned long long> addresses;
+            std::vector<AccessType> types;
+            size_t pos, len;
+        };
+        const size_t CHUNK = 4096;
+        std::vector<Stream> streams(readers.size(), Stream{std::vector<unsigned long long>(CHUNK),
+                                                           std::vector<AccessType>(CHUNK), 0, 0});
+        size_t active = readers.size();
+        std::vector<bool> done(readers.size(), false);
+        while (active > 0) {
+            for (size_t c = 0; c < readers.size(); ++c) {
+                if (done[c]) continue;
+                Stream& s = streams[c];
+                if (s.pos == s.len) {
+                    s.len = readers[c]->readBatch(s.addresses.data(), s.types.data(), CHUNK);
+                    s.pos = 0;
+                    if (s.len == 0) {
+                        done[c] = true;
+                        active--;
+                        continue;
+                    }
+                }
+                access(c, s.addresses[s.pos], s.types[s.pos]);
+                s.pos++;
+            }
+        }
+    }
+
+    for (const auto& reader : readers) malformed += reader->getMalformedLines();
+    if (malformed > 0) {
+        std::cerr << "Warning: Skipped " << malformed << " malformed trace lines." << std::endl;
+    }
+    if (out_of_range > 0) {
+        std::cerr << "Warning: Skipped " << out_of_range << " accesses from cores >= " << num_cores << "." << std::endl;
+    }
+    return true;
+}
+
+void MulticoreSystem::printStats() const {
+    for (const auto& l1 : l1s) {
+        l1->printStats();
+    }
+    shared.printStats();
+
+    size_t coherence_misses = stats.true_sharing_misses + stats.false_sharing_misses;
+    std::cout << "[Coherence] " << num_cores << " cores, MESI (directory), " << block_size << "B lines" << std::endl;
+    std::cout << "  Accesses: " << stats.accesses << "  Invalidations: " << stats.invalidations
+              << "  Upgrades (S->M): " << stats.upgrades << "  Downgrades (M/E->S): " << stats.downgrades
+              << "  Flushes: " << stats.flushes << std::endl;
+    std::cout << "  Coherence Misses: " << coherence_misses << " (true sharing: " << stats.true_sharing_misses
+              << ", false sharing: " << stats.false_sharing_misses << ")" << std::endl;
+}
+
+void MulticoreSystem::printSharingReport(size_t top) const {
+    std::vector<std::pair<unsigned long long, const LineReport*>> ranked;
+    for (const auto& kv : lines) {
+        if (kv.second.false_sharing > 0) ranked.push_back({kv.first, &kv.second});
+    }
+    std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) {
+        if (a.second->false_sharing != b.second->false_sharing) return a.second->false_sharing > b.second->false_sharing;
+        return a.first < b.first;
+    });
+    if (ranked.size() > top) ranked.resize(top);
+
+    std::cout << "False sharing hotspots (" << ranked.size() << " lines):" << std::endl;
+    if (ranked.empty()) return;
+    std::cout << std::left << std::setw(20) << "  Line" << std::right << std::setw(10) << "FS Miss"
+              << std::setw(10) << "TS Miss" << std::setw(8) << "Inval" << "  Words written / read" << std::endl;
+    for (const auto& entry : ranked) {
+        const LineReport& r = *entry.second;
+        std::ostringstream line;
+        line << "  0x" << std::hex << entry.first;
+        std::cout << std::left << std::setw(20) << line.str() << std::right << std::setw(10) << r.false_sharing
+                  << std::setw(10) << r.true_sharing << std::setw(8) << r.invalidations
+                  << "  W[" << wordList(r.words_written, CacheLevel::WORD_SIZE) << "]"
+                  << " R[" << wordList(r.words_read, CacheLevel::WORD_SIZE) << "]" << std::endl;
+    }
+}
@@ -0,0 +1,103 @@
+#include "../../include/Prefetcher.h"
+
+NextLinePrefetcher::NextLinePrefetcher(size_t _block_size, size_t _degree, size_t _distance)
+    : Prefetcher(_block_size, _degree, _distance) {}
+
+void NextLinePrefetcher::onAccess(unsigned long long block_address, bool hit, bool prefetched_hit,
+                                  std::vector<unsigned long long>& prefetches) {
+    if (hit && !prefetched_hit) return;
+    for (size_t k = 0; k < degree; ++k) {
+        prefetches.push_back(block_address + (distance + k) * block_size);
+    }
+}
+
+StridePrefetcher::StridePrefetcher(size_t _block_size, size_t _degree, size_t _distance)
+    : Prefetcher(_block_size, _degree, _distance), table(TABLE_SIZE, Entry{0, 0, 0, 0, false}) {}
+
+void StridePrefetcher::onAccess(unsigned long long block_address, bool, bool,
+                                std::vector<unsigned long long>& prefetches) {
+    const unsigned long long region = block_address >> REGION_SHIFT;
+    const long long block = (long long)(block_address / block_size);
+    Entry& e = table[region % TABLE_SIZE];
+
+    if (!e.valid || e.region != region) {
+        e = Entry{region, block, 0, 0, true};
+        return;
+    }
+
+    long long delta = block - e.last_block;
+    if (delta == 0) return; // same block again: no new information
+
+    if (delta == e.stride) {
+        if (e.confidence < MAX_CONFIDENCE) e.confidence++;
+    } else {
+        if (e.confidence > 0) e.confidence--;
+        if (e.confidence == 0) e.stride = delta;
+    }
+    e.last_block = block;
+
+    if (e.confidence == 0) return;
+    for (size_t k = 0; k < degree; ++k) {
+        long long target = block + e.stride * (long long)(distance + k);
+        if (target < 0) break;
+        prefetches.push_back((unsigned long long)target * block_size);
+    }
+}
+
+StreamBufferPrefetcher::StreamBufferPrefetcher(size_t _block_size, size_t _degree, size_t _distance, size_t num_buffers)
+    : Prefetcher(_block_size, _degree, _distance), buffers(num_buffers), clock(0), last_taken(0), dropped(0)
+{
+    for (Buffer& b : buffers) {
+        b.next = 0;
+        b.last_use = 0;
+    }
+}
+
+bool StreamBufferPrefetcher::takeBuffered(unsigned long long block_address) {
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        std::vector<unsigned long long>& blocks = buffers[i].blocks;
+        for (size_t pos = 0; pos < blocks.size(); ++pos) {
+            if (blocks[pos] != block_address) continue;
+            // entries in front of the hit were skipped by the stream
+            dropped += pos;
+            blocks.erase(blocks.begin(), blocks.begin() + pos + 1);
+            buffers[i].last_use = ++clock;
+            last_taken = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void StreamBufferPrefetcher::onAccess(unsigned long long block_address, bool hit, bool prefetched_hit,
+                                      std::vector<unsigned long long>& prefetches) {
+    if (hit && !prefetched_hit) return;
+
+    size_t target = last_taken;
+    if (!hit) {
+        // restart the least recently used buffer behind this miss
+        target = 0;
+        for (size_t i = 1; i < buffers.size(); ++i) {
+            if (buffers[i].last_use < buffers[target].last_use) target = i;
+        }
+        dropped += buffers[target].blocks.size();
+        buffers[target].blocks.clear();
+        buffers[target].next = block_address + distance * block_size;
+        buffers[target].last_use = ++clock;
+    }
+
+    Buffer& b = buffers[target];
+    while (b.blocks.size() < degree) {
+        b.blocks.push_back(b.next);
+        prefetches.push_back(b.next);
+        b.next += block_size;
+    }
+}
+
+std::unique_ptr<Prefetcher> createPrefetcher(const std::string& name, size_t block_size, size_t degree, size_t distance) {
+    if (degree == 0 || distance == 0) return nullptr;
+    if (name == "next_line") return std::make_unique<NextLinePrefetcher>(block_size, degree, distance);
+    if (name == "stride") return std::make_unique<StridePrefetcher>(block_size, degree, distance);
+    if (name == "stream") return std::make_unique<StreamBufferPrefetcher>(block_size, degree, distance);
+    return nullptr;
+}
@@ -1,6 +1,16 @@
 #include "../include/MemoryManager.h"
-#include "../include/Cache.h"
+#include "../include/CacheHierarchy.h"
 #include "../include/PageTable.h"
+#include "../include/TraceReplay.h"
+#include "../include/OptimalAnalyzer.h"
+#include "../include/StackDistance.h"
+#include "../include/SweepRunner.h"
+#include "../include/Multicore.h"
+#include "../include/TimingModel.h"
+#include "../include/Metrics.h"
+#include "../include/AllocTrace.h"
+#include "../include/CompactTrace.h"
+#include <iomanip>
 #include <iostream>
 #include <string>
 #include <sstream>
@@ -10,7 +20,7 @@
 void printHelp() {
     std::cout << "Available commands:\n"
               << "  init <size>             Initialize memory with size\n"
-              << "  set allocator <algo>    Set switch (first_fit, best_fit, worst_fit, buddy)\n"
+              << "  set allocator <algo>    Set switch (first_fit, best_fit, worst_fit, tlsf, buddy, slab)\n"
               << "  malloc <size>           Allocate memory\n"
               << "  free <id>               Free memory block by ID\n"
               << "  dump memory             Show memory map\n"
@@ -18,31 +28,371 @@ void printHelp() {
               << "  \n"
               << "  Cache Commands:\n"
               << "  cache init              Initialize L1 (1KB, 64B, 2-way) and L2 (4KB, 64B, 4-way)\n"
+              << "  cache clear             Remove all cache levels\n"
+              << "  cache add <size> <block_size> <assoc> [fifo|lru]\n"
+              << "                          Append a cache level below the current last one\n"
+              << "  cache inclusion <nine|inclusive|exclusive>\n"
+              << "                          Inclusion policy between levels (default: nine)\n"
+              << "  cache load <configfile> Build the hierarchy from a config file\n"
               << "  cache stats             Show cache hit/miss stats\n"
+              << "  cache write <lN> <wb|wt> [wa|nwa]\n"
+              << "                          Write-back/write-through and (no-)write-allocate per level\n"
+              << "  cache prefetch <lN> <none|next_line|stride|stream> [degree] [distance]\n"
+              << "                          Attach a hardware prefetcher to a level\n"
               << "  \n"
               << "  Virtual Memory Commands:\n"
-              << "  vm init <phys_size>     Init VM with Total Physical Size (Page Size fixed at 64B)\n"
-              << "  vm stats                Show Page Fault stats\n"
+              << "  vm init <phys_size> [page_size] [levels]\n"
+              << "                          Init VM with Total Physical Size (Page Size 64B by default,\n"
+              << "                          radix page table levels chosen to cover 64-bit addresses)\n"
+              << "  vm policy <name>        Page replacement: fifo, lru, clock, second_chance, 2q, arc\n"
+              << "  vm stats                Show Page Fault and TLB stats\n"
+              << "  vm tlb <l1_entries> <l1_assoc> <l2_entries> <l2_assoc> [fifo|lru]\n"
+              << "                          Configure the L1 dTLB / L2 STLB ('vm tlb off' disables it)\n"
               << "  vm dump                 Show Page Table\n"
-              << "  access <address>        Read address (translates Virtual -> Physical if VM active, then Cache)\n"
+              << "  access [load|store|ifetch] <address>\n"
+              << "                          Access address (translates Virtual -> Physical if VM active, then Cache)\n"
+              << "  replay <tracefile>      Stream a trace of addresses through VM + caches, print final stats only\n"
+              << "                          (text or compact binary trace, detected automatically)\n"
+              << "  trace convert <in> <out> [auto|text|lackey|pin]\n"
+              << "                          Convert a text, Valgrind Lackey or pinatrace trace to the compact format\n"
+              << "  trace info <trace>      Accesses, blocks and bytes per access of a compact trace\n"
+              << "  opt <tracefile>         Compare cache/page policies with Belady's optimal (OPT) on a trace\n"
+              << "  mrc <tracefile> [block_size] [max_sets]\n"
+              << "                          LRU miss-ratio curve for every cache size/associativity in one pass\n"
+              << "  sweep <configfile> <tracefile> [threads]\n"
+              << "                          Replay a trace through a grid of cache/VM configurations in parallel\n"
+              << "  gen access <pattern> <count> [key=value...]\n"
+              << "                          Replay generated accesses: sequential, strided, uniform, zipf, pointer_chase\n"
+              << "                          (ws=<bytes> granule= stride= alpha= writes=<0..1> phase=<accesses> base= seed=)\n"
+              << "  gen alloc <count> [key=value...]\n"
+              << "                          Generated malloc/free stream on the heap (dist=fixed|uniform|exp|pow2\n"
+              << "                          min= max= mean= life=<ops> lifetime=exp|fixed seed=)\n"
+              << "  alloctrace import <log> <trace>\n"
+              << "                          Convert a text malloc/free log (ltrace style or 'malloc <size> [handle]')\n"
+              << "                          to the binary allocation trace format\n"
+              << "  alloctrace replay <trace> Replay a binary allocation trace on the heap, output suppressed\n"
+              << "  alloctrace info <trace> | record <trace> | stop\n"
+              << "                          Show a trace header / capture the following malloc/free commands\n"
+              << "  timing [report]         Total cycles, AMAT and time breakdown of the accesses so far\n"
+              << "  timing <component> <cycles>\n"
+              << "                          Set a latency: l1..lN, memory, tlb, stlb, walk, fault, diskwrite\n"
+              << "  metrics export <json|csv> [file]\n"
+              << "                          All heap/cache/VM/timing counters (stdout without file)\n"
+              << "  metrics sample <n> <file> Every n accesses/allocations append hit rates, fault rate,\n"
+              << "                          fragmentation and free blocks to a CSV file ('metrics sample off' stops)\n"
+              << "  \n"
+              << "  Multicore Commands:\n"
+              << "  mc init <cores> [block_size] [l1_size] [l1_assoc] [l2_size] [l2_assoc]\n"
+              << "                          Private L1s + shared L2 kept coherent by MESI (64B, 1KB 2-way, 4KB 4-way)\n"
+              << "  mc access <core> [load|store|ifetch] <address>\n"
+              << "                          Access an address from one core\n"
+              << "  mc replay <tracefile> [tracefile...]\n"
+              << "                          One file of '<core> [type] <address>' lines, or one trace per core\n"
+              << "  mc stats                Per-core L1, shared cache and coherence stats\n"
+              << "  mc sharing [n]          Top n false-sharing cache lines (default 10)\n"
               << "  \n"
               << "  exit                    Exit simulator\n";
 }
 
-int main() {
+// "l1".."lN" -> 0..N-1
+bool parseCacheLevel(const std::string& token, size_t num_levels, size_t& index) {
+    if (token.size() < 2 || (token[0] != 'l' && token[0] != 'L')) return false;
+    size_t n = 0;
+    if (!(std::stringstream(token.substr(1)) >> n) || n < 1 || n > num_levels) return false;
+    index = n - 1;
+    return true;
+}
+
+void printUsage(const char* prog) {
+    std::cout << "Usage: " << prog << " [--replay <tracefile> [--vm <phys_size>] [--vm-policy <policy>]\n"
+              << "                  [--metrics <file.json|file.csv>] [--sample <n> <file.csv>]]\n"
+              << "       " << prog << " --replay <tracefile> --sweep <configfile> [--threads <n>]\n"
+              << "       " << prog << " --replay <tracefile> --cores <n>   (lines: <core> [type] <address>)\n"
+              << "       " << prog << " --gen \"<pattern> [key=value...]\" --count <n> [--vm ...] [--metrics ...] [--sample ...]\n"
+              << "       " << prog << " --gen-alloc \"[key=value...]\" --count <n> [--heap <size>] [--allocator <algo>]\n"
+              << "       " << prog << " --alloc-trace <trace> [--heap <size>] [--allocator <algo>]\n"
+              << "       " << prog << " --import-alloc <log> <trace>\n"
+              << "       " << prog << " --convert <in> <out> [--format <auto|text|lackey|pin>]\n"
+              << "  Without arguments the interactive simulator is started.\n";
+}
+
+// json unless the file name ends in .csv
+std::string metricsFormat(const std::string& path) {
+    return (path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0) ? "csv" : "json";
+}
+
+// "zipf ws=16M alpha=0.9" or "zipf,ws=16M,alpha=0.9" -> tokens
+std::vector<std::string> splitSpec(const std::string& spec) {
+    std::vector<std::string> tokens;
+    std::string token;
+    std::stringstream ss(spec);
+    while (std::getline(ss, token, ',')) {
+        std::stringstream words(token);
+        std::string word;
+        while (words >> word) tokens.push_back(word);
+    }
+    return tokens;
+}
+
+// tokens[0] is the pattern, the rest key=value options
+bool buildAddressGenerator(const std::vector<std::string>& tokens, std::unique_ptr<AddressGenerator>& generator) {
+    AddressStreamConfig config;
+    if (tokens.empty() || !parseAddressPattern(tokens[0], config.pattern)) {
+        std::cout << "Error: Unknown access pattern (sequential, strided, uniform, zipf, pointer_chase)\n";
+        return false;
+    }
+    if (!parseAddressOptions(std::vector<std::string>(tokens.begin() + 1, tokens.end()), config)) return false;
+    generator = std::make_unique<AddressGenerator>(config);
+    return true;
+}
+
+// options of the non-interactive replay
+struct BatchOptions {
+    std::string trace_path;
+    std::string gen_spec;       // generated accesses instead of a trace file
+    size_t count;               // accesses (or allocation operations) to generate
+    size_t vm_phys_size;        // 0 = VM disabled
+    std::string page_policy;
+    std::string metrics_path;
+    size_t sample_interval;
+    std::string sample_path;
+
+    BatchOptions() : count(0), vm_phys_size(0), page_policy("fifo"), sample_interval(0) {}
+};
+
+// Non-interactive replay: memsim --replay <tracefile> | --gen <spec> --count <n>
+//                         [--vm <phys_size>] [--vm-policy <policy>] [--metrics <file>] [--sample <n> <file>]
+int runBatchReplay(const BatchOptions& options) {
+    CacheHierarchy caches;
+    caches.initDefault();
+
+    std::unique_ptr<VirtualMemoryManager> vm;
+    if (options.vm_phys_size > 0) {
+        vm = std::make_unique<VirtualMemoryManager>(options.vm_phys_size, 64);
+        vm->setReplacementPolicy(options.page_policy);
+    }
+
+    std::unique_ptr<AddressGenerator> generator;
+    if (!options.gen_spec.empty() && !buildAddressGenerator(splitSpec(options.gen_spec), generator)) return 1;
+
+    IntervalSampler sampler;
+    if (!options.sample_path.empty() && !sampler.open(options.sample_path, options.sample_interval, caches, vm.get())) return 1;
+
+    TraceReplayer replayer(vm.get(), caches);
+    if (sampler.isOpen()) replayer.setSampler(&sampler);
+    if (generator) {
+        replayer.run(*generator, options.count);
+    } else if (!replayer.run(options.trace_path)) {
+        return 1;
+    }
+    sampler.close(&caches, vm.get(), nullptr);
+    replayer.printStats();
+
+    TimingModel timing;
+    timing.printReport(caches, vm.get());
+
+    if (!options.metrics_path.empty()) {
+        MetricSet metrics;
+        collectMetrics(caches, metrics);
+        if (vm) collectMetrics(*vm, metrics);
+        collectMetrics(timing, caches, vm.get(), metrics);
+        if (!exportMetrics(metrics, metricsFormat(options.metrics_path), options.metrics_path)) return 1;
+    }
+    return 0;
+}
+
+// Non-interactive allocation workload: memsim --gen-alloc <spec> --count <n> [--heap <size>] [--allocator <algo>]
+//                                    or memsim --alloc-trace <trace> [--heap <size>] [--allocator <algo>]
+int runAllocationWorkload(const std::string& spec, const std::string& trace_path, size_t count,
+                          size_t heap_size, const std::string& algo) {
+    AllocationStreamConfig config;
+    if (trace_path.empty() && !parseAllocationOptions(splitSpec(spec), config)) return 1;
+
+    MemoryManager heap;
+    heap.setAllocator(algo);
+    heap.init(heap_size);
+
+    AllocationDriver driver(heap);
+    if (!trace_path.empty()) {
+        AllocTraceReader reader(trace_path);
+        if (!reader.isOpen()) return 1;
+        driver.run(reader);
+    } else {
+        AllocationGenerator generator(config);
+        driver.run(generator, count);
+    }
+    driver.printStats();
+    heap.printStats();
+    return 0;
+}
+
+// memsim --import-alloc <log> <trace>
+int runAllocationImport(const std::string& log_path, const std::string& trace_path) {
+    AllocLogImporter importer;
+    if (!importer.run(log_path, trace_path)) return 1;
+    const AllocImportStats& stats = importer.getStats();
+    std::cout << "Imported " << stats.records << " records from " << stats.lines << " lines ("
+              << stats.skipped << " skipped, " << stats.unknown_frees << " unknown frees) to " << trace_path << "\n";
+    return 0;
+}
+
+// trace convert / memsim --convert <in> <out> [--format <name>]
+bool convertToCompact(const std::string& in_path, const std::string& out_path, const std::string& format_name) {
+    TraceFormat format;
+    if (!parseTraceFormat(format_name, format)) {
+        std::cout << "Error: Unknown trace format " << format_name << " (auto, text, lackey, pin)\n";
+        return false;
+    }
+    TraceConvertStats stats;
+    if (!convertTrace(in_path, out_path, format, stats)) return false;
+    std::cout << "Converted " << stats.accesses << " accesses from " << stats.lines << " lines ("
+              << stats.skipped << " skipped) to " << out_path << ": " << stats.input_bytes << " -> "
+              << stats.output_bytes << " bytes";
+    if (stats.accesses > 0 && stats.output_bytes > 0) {
+        std::cout << std::fixed << std::setprecision(2) << " (" << (double)stats.output_bytes / stats.accesses
+                  << " bytes/access, " << (double)stats.input_bytes / stats.output_bytes << "x smaller)";
+        std::cout.unsetf(std::ios::floatfield);
+    }
+    std::cout << "\n";
+    return true;
+}
+
+// Non-interactive multicore replay: memsim --replay <tracefile> --cores <n>
+int runMulticoreReplay(const std::string& trace_path, size_t cores) {
+    MulticoreSystem mc;
+    if (!mc.init(cores, 64, 1024, 2, 4096, 4)) return 1;
+    if (!mc.run({trace_path})) return 1;
+    mc.printStats();
+    mc.printSharingReport(10);
+    return 0;
+}
+
+// Non-interactive sweep: memsim --replay <tracefile> --sweep <configfile> [--threads <n>]
+int runSweep(const std::string& trace_path, const std::string& config_path, size_t threads) {
+    SweepRunner sweep;
+    if (!sweep.loadGrid(config_path)) return 1;
+    if (!sweep.run(trace_path, threads)) return 1;
+    sweep.printResults();
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) {
+        BatchOptions options;
+        std::string sweep_path;
+        size_t threads = 0;
+        size_t cores = 0;
+        bool alloc_mode = false;
+        std::string alloc_spec;
+        std::string alloc_trace;
+        std::string import_log;
+        std::string convert_in, convert_out;
+        std::string trace_format = "auto";
+        size_t heap_size = 1 << 20;
+        std::string algo = "first_fit";
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            // numeric options
+            size_t* number = nullptr;
+            if (arg == "--threads") number = &threads;
+            else if (arg == "--cores") number = &cores;
+            else if (arg == "--vm") number = &options.vm_phys_size;
+            else if (arg == "--count") number = &options.count;
+            else if (arg == "--heap") number = &heap_size;
+
+            if (number && i + 1 < argc) {
+                try {
+                    *number = std::stoull(argv[++i]);
+                } catch (...) {
+                    printUsage(argv[0]);
+                    return 1;
+                }
+            } else if (arg == "--replay" && i + 1 < argc) {
+                options.trace_path = argv[++i];
+            } else if (arg == "--gen" && i + 1 < argc) {
+                options.gen_spec = argv[++i];
+            } else if (arg == "--gen-alloc" && i + 1 < argc) {
+                alloc_mode = true;
+                alloc_spec = argv[++i];
+            } else if (arg == "--alloc-trace" && i + 1 < argc) {
+                alloc_trace = argv[++i];
+            } else if (arg == "--import-alloc" && i + 2 < argc) {
+                import_log = argv[++i];
+                alloc_trace = argv[++i];
+            } else if (arg == "--convert" && i + 2 < argc) {
+                convert_in = argv[++i];
+                convert_out = argv[++i];
+            } else if (arg == "--format" && i + 1 < argc) {
+                trace_format = argv[++i];
+            } else if (arg == "--allocator" && i + 1 < argc) {
+                algo = argv[++i];
+            } else if (arg == "--sweep" && i + 1 < argc) {
+                sweep_path = argv[++i];
+            } else if (arg == "--metrics" && i + 1 < argc) {
+                options.metrics_path = argv[++i];
+            } else if (arg == "--sample" && i + 2 < argc) {
+                try {
+                    options.sample_interval = std::stoull(argv[++i]);
+                } catch (...) {
+                    printUsage(argv[0]);
+                    return 1;
+                }
+                options.sample_path = argv[++i];
+            } else if (arg == "--vm-policy" && i + 1 < argc) {
+                options.page_policy = argv[++i];
+            } else {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        if (!import_log.empty()) return runAllocationImport(import_log, alloc_trace);
+        if (!convert_in.empty()) return convertToCompact(convert_in, convert_out, trace_format) ? 0 : 1;
+        if (!alloc_trace.empty()) return runAllocationWorkload("", alloc_trace, 0, heap_size, algo);
+        if (alloc_mode || !options.gen_spec.empty()) {
+            if (options.count == 0) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            if (alloc_mode) return runAllocationWorkload(alloc_spec, "", options.count, heap_size, algo);
+            return runBatchReplay(options);
+        }
+        if (options.trace_path.empty()) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        if (!sweep_path.empty()) return runSweep(options.trace_path, sweep_path, threads);
+        if (cores > 0) return runMulticoreReplay(options.trace_path, cores);
+        return runBatchReplay(options);
+    }
+
     MemoryManager memManager;
     
-    // Simple 2-level cache hierarchy
-    std::unique_ptr<CacheLevel> l1;
-    std::unique_ptr<CacheLevel> l2;
+    // Cache hierarchy, L1 first
+    CacheHierarchy caches;
     
     // Virtual Memory
     std::unique_ptr<VirtualMemoryManager> vm;
     bool use_vm = false;
+    std::string page_policy = "fifo"; // applied to every new VM
+
+    // Multicore mode (independent of the single-core caches and VM)
+    MulticoreSystem multicore;
+
+    // Cycle costs applied to the single-core counters
+    TimingModel timing;
+
+    // Optional capture of malloc/free commands (handles = block IDs)
+    AllocTraceWriter recorder;
+    uint64_t recorded_ops = 0;
+
+    // Optional time series of accesses and allocations
+    IntervalSampler sampler;
+    auto sampleEvent = [&]() {
+        if (sampler.isOpen()) sampler.advance(1, &caches, (use_vm && vm) ? vm.get() : nullptr, &memManager);
+    };
 
     // Default init for cache
-    l1 = std::make_unique<CacheLevel>("L1 Cache", 1024, 64, 2, ReplacementPolicy::FIFO);
-    l2 = std::make_unique<CacheLevel>("L2 Cache", 4096, 64, 4, ReplacementPolicy::FIFO);
+    caches.initDefault();
 
     std::string line;
     
@@ -67,11 +417,20 @@ int main() {
             if (sub == "init") {
                 size_t phys_size;
                 if (ss >> phys_size) {
-                    // Page size matched to Cache Block Size for simplicity (64B)
-                    vm = std::make_unique<VirtualMemoryManager>(phys_size, 64);
+                    // Page size matched to Cache Block Size for simplicity (64B) unless given
+                    size_t page_size = 64;
+                    int levels = 0;
+                    if (ss >> page_size) ss >> levels;
+                    if (levels < 0 || !VirtualMemoryManager::levelsFit(page_size, levels)) {
+                        std::cout << "Error: " << levels << " page-table levels do not fit a "
+                                  << page_size << "-byte page's VPN.\n";
+                        continue;
+                    }
+                    vm = std::make_unique<VirtualMemoryManager>(phys_size, page_size, levels);
+                    if (page_policy != "fifo") vm->setReplacementPolicy(page_policy);
                     use_vm = true;
                 } else {
-                    std::cout << "Usage: vm init <physical_memory_size>\n";
+                    std::cout << "Usage: vm init <physical_memory_size> [page_size] [levels]\n";
                 }
             } else if (sub == "stats") {
                 if(vm) vm->printStats();
@@ -79,24 +438,129 @@ int main() {
             } else if (sub == "dump") {
                 if(vm) vm->printPageTable();
                 else std::cout << "VM not initialized.\n";
+            } else if (sub == "policy") {
+                std::string name;
+                if (ss >> name) {
+                    page_policy = name;
+                    if (vm) vm->setReplacementPolicy(name);
+                    else std::cout << "Page replacement policy will be " << name << " on vm init.\n";
+                } else {
+                    std::cout << "Usage: vm policy <fifo|lru|clock|second_chance|2q|arc>\n";
+                }
+            } else if (sub == "tlb") {
+                std::string first;
+                size_t l1_entries = 0, l1_assoc = 0, l2_entries = 0, l2_assoc = 0;
+                std::string policy_name = "lru";
+                if (!vm) {
+                    std::cout << "VM not initialized.\n";
+                } else if (ss >> first && first == "off") {
+                    vm->configureTLB(0, 0, 0, 0, ReplacementPolicy::LRU);
+                    std::cout << "TLB disabled.\n";
+                } else if (!first.empty() && (std::stringstream(first) >> l1_entries)
+                           && ss >> l1_assoc >> l2_entries >> l2_assoc) {
+                    ss >> policy_name;
+                    ReplacementPolicy policy = (policy_name == "fifo") ? ReplacementPolicy::FIFO : ReplacementPolicy::LRU;
+                    vm->configureTLB(l1_entries, l1_assoc, l2_entries, l2_assoc, policy);
+                    std::cout << "TLB configured.\n";
+                } else {
+                    std::cout << "Usage: vm tlb <l1_entries> <l1_assoc> <l2_entries> <l2_assoc> [fifo|lru] | vm tlb off\n";
+                }
             }
         }
         else if (command == "cache") {
             std::string sub;
             ss >> sub;
             if (sub == "init") {
-                l1 = std::make_unique<CacheLevel>("L1 Cache", 1024, 64, 2, ReplacementPolicy::FIFO);
-                l2 = std::make_unique<CacheLevel>("L2 Cache", 4096, 64, 4, ReplacementPolicy::FIFO);
+                caches.initDefault();
                 std::cout << "Caches initialized.\n";
+            } else if (sub == "clear") {
+                caches.clear();
+                std::cout << "All cache levels removed.\n";
+            } else if (sub == "add") {
+                size_t size, block, assoc;
+                std::string policy = "fifo";
+                if (ss >> size >> block >> assoc) {
+                    ss >> policy;
+                    ReplacementPolicy replacement = (policy == "lru") ? ReplacementPolicy::LRU : ReplacementPolicy::FIFO;
+                    if (caches.addLevel(size, block, assoc, replacement)) {
+                        std::cout << "Added L" << caches.numLevels() << " Cache (" << size << "B, " << block << "B blocks, "
+                                  << assoc << "-way, " << (replacement == ReplacementPolicy::LRU ? "LRU" : "FIFO") << ")\n";
+                    }
+                } else {
+                    std::cout << "Usage: cache add <size> <block_size> <assoc> [fifo|lru]\n";
+                }
+            } else if (sub == "inclusion") {
+                std::string name;
+                InclusionPolicy policy;
+                if (ss >> name && parseInclusionPolicy(name, policy)) {
+                    if (caches.setInclusion(policy)) {
+                        std::cout << "Cache inclusion policy: " << inclusionPolicyName(policy) << "\n";
+                    }
+                } else {
+                    std::cout << "Usage: cache inclusion <nine|inclusive|exclusive>\n";
+                }
+            } else if (sub == "load") {
+                std::string path;
+                if (ss >> path) {
+                    if (caches.loadConfig(path)) {
+                        std::cout << "Loaded " << caches.numLevels() << " cache levels ("
+                                  << inclusionPolicyName(caches.getInclusion()) << ") from " << path << "\n";
+                    }
+                } else {
+                    std::cout << "Usage: cache load <configfile>\n";
+                }
             } else if (sub == "stats") {
-                if (l1) l1->printStats();
-                if (l2) l2->printStats();
+                caches.printStats();
+            } else if (sub == "write") {
+                std::string level, mode, alloc = "wa";
+                size_t index = 0;
+                if (ss >> level >> mode && parseCacheLevel(level, caches.numLevels(), index)
+                    && (mode == "wb" || mode == "wt")) {
+                    ss >> alloc;
+                    CacheLevel& target = caches.getLevel(index);
+                    target.setWritePolicy(mode == "wb" ? WritePolicy::WRITE_BACK : WritePolicy::WRITE_THROUGH, alloc != "nwa");
+                    std::cout << target.getName() << ": " << (mode == "wb" ? "write-back" : "write-through")
+                              << ", " << (alloc != "nwa" ? "write-allocate" : "no-write-allocate") << "\n";
+                } else {
+                    std::cout << "Usage: cache write <lN> <wb|wt> [wa|nwa]\n";
+                }
+            } else if (sub == "prefetch") {
+                std::string level, name;
+                size_t index = 0, degree = 1, distance = 1;
+                if (ss >> level >> name && parseCacheLevel(level, caches.numLevels(), index)) {
+                    ss >> degree >> distance;
+                    if (caches.setPrefetcher(index, name, degree, distance)) {
+                        const CacheLevel& target = caches.getLevel(index);
+                        if (target.getPrefetcher()) {
+                            std::cout << target.getName() << ": " << name << " prefetcher (degree " << degree
+                                      << ", distance " << distance << ")\n";
+                        } else {
+                            std::cout << target.getName() << ": prefetching disabled\n";
+                        }
+                    }
+                } else {
+                    std::cout << "Usage: cache prefetch <lN> <none|next_line|stride|stream> [degree] [distance]\n";
+                }
             } else {
-                std::cout << "Usage: cache <init|stats>\n";
+                std::cout << "Usage: cache <init|clear|add|inclusion|load|stats|write|prefetch>\n";
             }
         } else if (command == "access") {
-            std::string addrStr;
-            if (ss >> addrStr) {
+            std::string token, addrStr;
+            AccessType type = AccessType::LOAD;
+            if (ss >> token) {
+                if (token == "load" || token == "r") {
+                    ss >> addrStr;
+                } else if (token == "store" || token == "w") {
+                    type = AccessType::STORE;
+                    ss >> addrStr;
+                } else if (token == "ifetch" || token == "i") {
+                    type = AccessType::IFETCH;
+                    ss >> addrStr;
+                } else {
+                    addrStr = token;
+                }
+            }
+            if (!addrStr.empty()) {
                 unsigned long long v_addr;
                 unsigned long long p_addr;
                 try {
@@ -108,30 +572,314 @@ int main() {
 
                 if (use_vm && vm) {
                     std::cout << "Virtual Address: 0x" << std::hex << v_addr << std::dec << "\n";
-                    p_addr = vm->translate(v_addr);
+                    p_addr = vm->translate(v_addr, type == AccessType::STORE);
                     std::cout << "Translated to Physical Address: 0x" << std::hex << p_addr << std::dec << "\n";
                 } else {
                     p_addr = v_addr;
                     std::cout << "Physical Address: 0x" << std::hex << p_addr << std::dec << " (VM disabled)\n";
                 }
                 
-                // L1 Access
-                bool hit1 = l1->access(p_addr);
-                if (hit1) {
-                    std::cout << "L1 Cache HIT\n";
-                } else {
-                    std::cout << "L1 Cache MISS -> Accessing L2...\n";
-                    // L2 Access
-                    bool hit2 = l2->access(p_addr);
-                    if (hit2) {
-                        std::cout << "L2 Cache HIT\n";
+                // L1 -> L2 -> ... -> Memory, including writebacks and forwarded stores
+                const size_t n = caches.numLevels();
+                size_t served = caches.access(p_addr, type);
+                if (n == 0) {
+                    std::cout << "No caches configured -> Main Memory Access\n";
+                }
+                for (size_t i = 0; i < n && i <= served; ++i) {
+                    if (i == served) {
+                        std::cout << "L" << i + 1 << " Cache HIT\n";
+                    } else if (i + 1 < n) {
+                        std::cout << "L" << i + 1 << " Cache MISS -> Accessing L" << i + 2 << "...\n";
+                    } else {
+                        std::cout << "L" << i + 1 << " Cache MISS -> Main Memory Access\n";
+                    }
+                }
+                if (n > 0 && caches.getLevel(0).lastRequests().writeback) {
+                    std::cout << "L1 dirty line 0x" << std::hex << caches.getLevel(0).lastRequests().victim_address << std::dec
+                              << " written back to " << (n > 1 ? "L2" : "memory") << "\n";
+                }
+                sampleEvent();
+
+            } else {
+                std::cout << "Usage: access [load|store|ifetch] <address>\n";
+            }
+        } else if (command == "replay") {
+            std::string path;
+            if (ss >> path) {
+                TraceReplayer replayer((use_vm && vm) ? vm.get() : nullptr, caches);
+                if (sampler.isOpen()) replayer.setSampler(&sampler);
+                if (replayer.run(path)) {
+                    replayer.printStats();
+                    timing.printReport(caches, (use_vm && vm) ? vm.get() : nullptr);
+                }
+            } else {
+                std::cout << "Usage: replay <tracefile>\n";
+            }
+        } else if (command == "gen") {
+            std::string sub;
+            size_t count = 0;
+            ss >> sub;
+            std::vector<std::string> tokens;
+            std::string token;
+            if (sub == "access") {
+                std::string pattern;
+                if (ss >> pattern >> count && count > 0) {
+                    tokens.push_back(pattern);
+                    while (ss >> token) tokens.push_back(token);
+                    std::unique_ptr<AddressGenerator> generator;
+                    if (buildAddressGenerator(tokens, generator)) {
+                        TraceReplayer replayer((use_vm && vm) ? vm.get() : nullptr, caches);
+                        if (sampler.isOpen()) replayer.setSampler(&sampler);
+                        replayer.run(*generator, count);
+                        replayer.printStats();
+                        timing.printReport(caches, (use_vm && vm) ? vm.get() : nullptr);
+                    }
+                } else {
+                    std::cout << "Usage: gen access <sequential|strided|uniform|zipf|pointer_chase> <count> [key=value...]\n";
+                }
+            } else if (sub == "alloc") {
+                if (ss >> count && count > 0) {
+                    while (ss >> token) tokens.push_back(token);
+                    AllocationStreamConfig config;
+                    if (parseAllocationOptions(tokens, config)) {
+                        AllocationGenerator generator(config);
+                        AllocationDriver driver(memManager);
+                        if (sampler.isOpen()) driver.setSampler(&sampler);
+                        driver.run(generator, count);
+                        driver.printStats();
+                    }
+                } else {
+                    std::cout << "Usage: gen alloc <count> [key=value...]\n";
+                }
+            } else {
+                std::cout << "Usage: gen <access|alloc> ...\n";
+            }
+        } else if (command == "opt") {
+            std::string path;
+            if (ss >> path) {
+                std::vector<const CacheLevel*> levels;
+                for (size_t i = 0; i < caches.numLevels(); ++i) levels.push_back(&caches.getLevel(i));
+                OptimalAnalyzer analyzer(levels, (use_vm && vm) ? vm.get() : nullptr);
+                analyzer.run(path);
+            } else {
+                std::cout << "Usage: opt <tracefile>\n";
+            }
+        } else if (command == "mrc") {
+            std::string path;
+            if (ss >> path) {
+                size_t block = caches.numLevels() > 0 ? caches.getLevel(0).getBlockSize() : 64;
+                size_t max_sets = 64;
+                ss >> block >> max_sets;
+                if (block == 0 || (block & (block - 1)) != 0 || (max_sets & (max_sets - 1)) != 0) {
+                    std::cout << "Block size and set count must be powers of 2.\n";
+                } else if (max_sets > StackDistanceAnalyzer::MAX_SETS) {
+                    std::cout << "Set count must be at most " << StackDistanceAnalyzer::MAX_SETS << ".\n";
+                } else {
+                    StackDistanceAnalyzer analyzer(block, max_sets);
+                    if (analyzer.run(path)) analyzer.printCurve();
+                }
+            } else {
+                std::cout << "Usage: mrc <tracefile> [block_size] [max_sets]\n";
+            }
+        } else if (command == "sweep") {
+            std::string config_path, path;
+            size_t threads = 0;
+            if (ss >> config_path >> path) {
+                ss >> threads;
+                SweepRunner sweep;
+                if (sweep.loadGrid(config_path) && sweep.run(path, threads)) {
+                    sweep.printResults();
+                }
+            } else {
+                std::cout << "Usage: sweep <configfile> <tracefile> [threads]\n";
+            }
+        } else if (command == "mc") {
+            std::string sub;
+            ss >> sub;
+            if (sub == "init") {
+                size_t cores = 0, block = 64, l1_size = 1024, l1_assoc = 2, l2_size = 4096, l2_assoc = 4;
+                if (ss >> cores) {
+                    ss >> block >> l1_size >> l1_assoc >> l2_size >> l2_assoc;
+                    if (multicore.init(cores, block, l1_size, l1_assoc, l2_size, l2_assoc)) {
+                        std::cout << "Multicore initialized: " << cores << " cores, private L1 " << l1_size << "B "
+                                  << l1_assoc << "-way, shared L2 " << l2_size << "B " << l2_assoc << "-way, "
+                                  << block << "B lines, MESI.\n";
+                    }
+                } else {
+                    std::cout << "Usage: mc init <cores> [block_size] [l1_size] [l1_assoc] [l2_size] [l2_assoc]\n";
+                }
+            } else if (!multicore.isInitialized()) {
+                std::cout << "Multicore not initialized. Use 'mc init <cores>'.\n";
+            } else if (sub == "access") {
+                size_t core;
+                std::string token, addrStr;
+                AccessType type = AccessType::LOAD;
+                if (ss >> core >> token) {
+                    if (token == "load" || token == "r") {
+                        ss >> addrStr;
+                    } else if (token == "store" || token == "w") {
+                        type = AccessType::STORE;
+                        ss >> addrStr;
+                    } else if (token == "ifetch" || token == "i") {
+                        type = AccessType::IFETCH;
+                        ss >> addrStr;
                     } else {
-                        std::cout << "L2 Cache MISS -> Main Memory Access\n";
+                        addrStr = token;
+                    }
+                }
+                unsigned long long addr = 0;
+                bool valid = !addrStr.empty() && core < multicore.getNumCores();
+                if (valid) {
+                    try {
+                        addr = std::stoull(addrStr, nullptr, 0);
+                    } catch (...) {
+                        valid = false;
                     }
                 }
+                if (!valid) {
+                    std::cout << "Usage: mc access <core> [load|store|ifetch] <address>\n";
+                    continue;
+                }
 
+                CoherenceResult r = multicore.access(core, addr, type);
+                std::cout << "Core " << core << " L1 " << (r.served == 0 ? "HIT" : "MISS");
+                if (r.miss == CoherenceMiss::TRUE_SHARING) std::cout << " (coherence miss: true sharing)";
+                if (r.miss == CoherenceMiss::FALSE_SHARING) std::cout << " (coherence miss: false sharing)";
+                if (r.served == 1) std::cout << " -> Shared L2 HIT";
+                if (r.served > 1) std::cout << " -> Shared L2 MISS -> Main Memory Access";
+                std::cout << "\n";
+                if (r.downgraded >= 0) {
+                    std::cout << "  Core " << r.downgraded << " copy downgraded to Shared"
+                              << (r.flushed ? " (dirty data written back)" : "") << "\n";
+                }
+                for (size_t k = 0; r.invalidated >> k; ++k) {
+                    if (r.invalidated >> k & 1) std::cout << "  Core " << k << " copy invalidated\n";
+                }
+                if (r.invalidated && r.flushed) std::cout << "  Modified data written back to Shared L2\n";
+            } else if (sub == "replay") {
+                std::vector<std::string> paths;
+                std::string path;
+                while (ss >> path) paths.push_back(path);
+                if (paths.empty()) {
+                    std::cout << "Usage: mc replay <tracefile> [tracefile...]\n";
+                } else if (multicore.run(paths)) {
+                    multicore.printStats();
+                }
+            } else if (sub == "stats") {
+                multicore.printStats();
+            } else if (sub == "sharing") {
+                size_t top = 10;
+                ss >> top;
+                multicore.printSharingReport(top);
+            } else {
+                std::cout << "Usage: mc <init|access|replay|stats|sharing>\n";
+            }
+        } else if (command == "timing") {
+            std::string sub;
+            if (!(ss >> sub) || sub == "report") {
+                timing.printReport(caches, (use_vm && vm) ? vm.get() : nullptr);
+            } else {
+                unsigned long long cycles;
+                if ((ss >> cycles) && timing.set(sub, cycles)) {
+                    std::cout << "Latency of " << sub << " set to " << cycles << " cycles.\n";
+                } else {
+                    std::cout << "Usage: timing <l1..l" << TimingModel::MAX_CACHE_LEVELS
+                              << "|memory|tlb|stlb|walk|fault|diskwrite> <cycles>\n";
+                }
+            }
+        } else if (command == "trace") {
+            std::string sub, path, out_path;
+            ss >> sub;
+            if (sub == "convert" && ss >> path >> out_path) {
+                std::string format = "auto";
+                ss >> format;
+                convertToCompact(path, out_path, format);
+            } else if (sub == "info" && ss >> path) {
+                CompactTraceReader reader(path);
+                if (reader.isOpen()) {
+                    std::cout << path << ": " << reader.getAccessCount() << " accesses, " << reader.getBlockCount()
+                              << " blocks, " << reader.getFileSize() << " bytes";
+                    if (reader.getAccessCount() > 0) {
+                        std::cout << std::fixed << std::setprecision(2) << " ("
+                                  << (double)reader.getFileSize() / reader.getAccessCount() << " bytes/access)";
+                        std::cout.unsetf(std::ios::floatfield);
+                    }
+                    std::cout << "\n";
+                }
+            } else {
+                std::cout << "Usage: trace <convert <in> <out> [auto|text|lackey|pin] | info <trace>>\n";
+            }
+        } else if (command == "alloctrace") {
+            std::string sub, path, out_path;
+            ss >> sub;
+            if (sub == "import" && ss >> path >> out_path) {
+                AllocLogImporter importer;
+                if (importer.run(path, out_path)) {
+                    const AllocImportStats& st = importer.getStats();
+                    std::cout << "Imported " << st.records << " records from " << st.lines << " lines ("
+                              << st.skipped << " skipped, " << st.unknown_frees << " unknown frees) to " << out_path << "\n";
+                }
+            } else if (sub == "info" && ss >> path) {
+                AllocTraceReader reader(path);
+                if (reader.isOpen()) {
+                    std::cout << path << ": " << reader.getHeader().records << " records, "
+                              << reader.getHeader().handles << " handles\n";
+                }
+            } else if (sub == "replay" && ss >> path) {
+                AllocTraceReader reader(path);
+                if (reader.isOpen()) {
+                    AllocationDriver driver(memManager);
+                    if (sampler.isOpen()) driver.setSampler(&sampler);
+                    driver.run(reader);
+                    driver.printStats();
+                }
+            } else if (sub == "record" && ss >> path) {
+                if (recorder.open(path)) {
+                    recorded_ops = 0;
+                    std::cout << "Recording malloc/free to " << path << "\n";
+                }
+            } else if (sub == "stop") {
+                if (recorder.isOpen()) {
+                    std::cout << recorder.close() << " operations recorded.\n";
+                } else {
+                    std::cout << "Not recording.\n";
+                }
+            } else {
+                std::cout << "Usage: alloctrace <import <log> <trace> | info <trace> | replay <trace> | record <trace> | stop>\n";
+            }
+        } else if (command == "metrics") {
+            std::string sub;
+            ss >> sub;
+            if (sub == "export") {
+                std::string format, path;
+                if (ss >> format) {
+                    ss >> path;
+                    MetricSet metrics;
+                    collectMetrics(memManager, metrics);
+                    collectMetrics(caches, metrics);
+                    if (use_vm && vm) collectMetrics(*vm, metrics);
+                    collectMetrics(timing, caches, (use_vm && vm) ? vm.get() : nullptr, metrics);
+                    if (exportMetrics(metrics, format, path) && !path.empty() && path != "-") {
+                        std::cout << metrics.size() << " metrics written to " << path << "\n";
+                    }
+                } else {
+                    std::cout << "Usage: metrics export <json|csv> [file]\n";
+                }
+            } else if (sub == "sample") {
+                std::string arg, path;
+                size_t interval;
+                if (ss >> arg && arg == "off") {
+                    sampler.close(&caches, (use_vm && vm) ? vm.get() : nullptr, &memManager);
+                    std::cout << "Sampling stopped.\n";
+                } else if (std::stringstream(arg) >> interval && ss >> path) {
+                    if (sampler.open(path, interval, caches, (use_vm && vm) ? vm.get() : nullptr)) {
+                        std::cout << "Sampling every " << interval << " events to " << path << "\n";
+                    }
+                } else {
+                    std::cout << "Usage: metrics sample <n> <file> | metrics sample off\n";
+                }
             } else {
-                std::cout << "Usage: access <address>\n";
+                std::cout << "Usage: metrics <export|sample>\n";
             }
         } else if (command == "init") {
             size_t size;
@@ -147,7 +895,7 @@ int main() {
                 if (ss >> algo) {
                     memManager.setAllocator(algo);
                 } else {
-                    std::cout << "Usage: set allocator <first_fit|best_fit|worst_fit|buddy>\n";
+                    std::cout << "Usage: set allocator <first_fit|best_fit|worst_fit|tlsf|buddy|slab>\n";
                 }
             } else {
                 std::cout << "Unknown set command.\n";
@@ -155,14 +903,17 @@ int main() {
         } else if (command == "malloc") {
             size_t size;
             if (ss >> size) {
-                memManager.my_malloc(size);
+                int id = memManager.my_malloc(size);
+                if (id >= 0 && recorder.isOpen()) recorder.write({AllocOpType::MALLOC, (uint32_t)id, size, recorded_ops++});
+                sampleEvent();
             } else {
                 std::cout << "Usage: malloc <size>\n";
             }
         } else if (command == "free") {
             int id;
             if (ss >> id) {
-                memManager.my_free(id);
+                if (memManager.my_free(id) && recorder.isOpen()) recorder.write({AllocOpType::FREE, (uint32_t)id, 0, recorded_ops++});
+                sampleEvent();
             } else {
                 std::cout << "Usage: free <id>\n";
             }
@@ -179,6 +930,7 @@ int main() {
             std::cout << "Unknown command: " << command << "\n";
         }
     }
+    sampler.close(&caches, (use_vm && vm) ? vm.get() : nullptr, &memManager);
 
     return 0;
 }
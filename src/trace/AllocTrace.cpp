@@ -0,0 +1,384 @@
+#include "../../include/AllocTrace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+const char MAGIC[4] = {'M', 'S', 'A', 'T'};
+const uint32_t VERSION = 1;
+const size_t HEADER_SIZE = 24;
+const size_t RECORD_SIZE = 21;
+const size_t RECORDS_PER_CHUNK = 1 << 16;
+
+void putLE(unsigned char* p, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) p[i] = (unsigned char)(value >> (8 * i));
+}
+
+uint64_t getLE(const unsigned char* p, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) value |= (uint64_t)p[i] << (8 * i);
+    return value;
+}
+
+void encodeHeader(unsigned char* p, const AllocTraceHeader& header) {
+    std::memcpy(p, MAGIC, 4);
+    putLE(p + 4, VERSION, 4);
+    putLE(p + 8, header.records, 8);
+    putLE(p + 16, header.handles, 8);
+}
+
+bool parseNumber(const std::string& text, unsigned long long& value) {
+    try {
+        size_t pos = 0;
+        value = std::stoull(text, &pos, 0);
+        return pos == text.size();
+    } catch (...) {
+        return false;
+    }
+}
+
+// "0x55d0c0", "(nil)", "NULL", "0" -> value; false if not a pointer
+bool parsePointer(std::string text, unsigned long long& value) {
+    text.erase(std::remove_if(text.begin(), text.end(), [](char c) { return c == ' ' || c == '\t'; }), text.end());
+    if (text == "(nil)" || text == "NULL" || text == "nil") {
+        value = 0;
+        return true;
+    }
+    if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        try {
+            size_t pos = 0;
+            value = std::stoull(text.substr(2), &pos, 16);
+            return pos == text.size() - 2;
+        } catch (...) {
+            return false;
+        }
+    }
+    return parseNumber(text, value);
+}
+
+// leading "123" or "12.345" token: ticks or seconds (stored as ns)
+bool parseTimestamp(const std::string& token, uint64_t& timestamp) {
+    if (token.empty() || !(token[0] >= '0' && token[0] <= '9')) return false;
+    if (token.find_first_not_of("0123456789.") != std::string::npos) return false;
+    if (token.find('.') == std::string::npos) {
+        unsigned long long value;
+        if (!parseNumber(token, value)) return false;
+        timestamp = value;
+        return true;
+    }
+    try {
+        timestamp = (uint64_t)(std::stod(token) * 1e9);
+    } catch (...) {
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+AllocTraceWriter::AllocTraceWriter() : file(nullptr), header{0, 0} {}
+
+AllocTraceWriter::~AllocTraceWriter() {
+    close();
+}
+
+bool AllocTraceWriter::open(const std::string& path) {
+    close();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Error: Cannot write allocation trace " << path << std::endl;
+        return false;
+    }
+    header = {0, 0};
+    unsigned char placeholder[HEADER_SIZE];
+    encodeHeader(placeholder, header);
+    std::fwrite(placeholder, 1, HEADER_SIZE, file);
+    buffer.clear();
+    buffer.reserve(RECORDS_PER_CHUNK * RECORD_SIZE);
+    return true;
+}
+
+void AllocTraceWriter::flush() {
+    if (!buffer.empty()) std::fwrite(buffer.data(), 1, buffer.size(), file);
+    buffer.clear();
+}
+
+void AllocTraceWriter::write(const AllocOp& op) {
+    if (!file) return;
+    unsigned char record[RECORD_SIZE];
+    record[0] = (unsigned char)op.op;
+    putLE(record + 1, op.handle, 4);
+    putLE(record + 5, op.size, 8);
+    putLE(record + 13, op.timestamp, 8);
+    buffer.insert(buffer.end(), record, record + RECORD_SIZE);
+    if (buffer.size() >= RECORDS_PER_CHUNK * RECORD_SIZE) flush();
+
+    header.records++;
+    header.handles = std::max<uint64_t>(header.handles, (uint64_t)op.handle + 1);
+}
+
+uint64_t AllocTraceWriter::close() {
+    if (!file) return 0;
+    flush();
+    unsigned char final_header[HEADER_SIZE];
+    encodeHeader(final_header, header);
+    std::fseek(file, 0, SEEK_SET);
+    std::fwrite(final_header, 1, HEADER_SIZE, file);
+    std::fclose(file);
+    file = nullptr;
+    return header.records;
+}
+
+AllocTraceReader::AllocTraceReader(const std::string& path)
+    : file(nullptr), header{0, 0}, remaining(0)
+{
+    file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        std::cerr << "Error: Cannot open allocation trace " << path << std::endl;
+        return;
+    }
+    unsigned char raw[HEADER_SIZE];
+    if (std::fread(raw, 1, HEADER_SIZE, file) != HEADER_SIZE || std::memcmp(raw, MAGIC, 4) != 0) {
+        std::cerr << "Error: " << path << " is not an allocation trace" << std::endl;
+    } else if (getLE(raw + 4, 4) != VERSION) {
+        std::cerr << "Error: Unsupported allocation trace version " << getLE(raw + 4, 4) << std::endl;
+    } else if (getLE(raw + 16, 8) > getLE(raw + 8, 8)) {
+        // every handle is introduced by a record, so more handles than records means a damaged header
+        std::cerr << "Error: " << path << " has a corrupt header (" << getLE(raw + 16, 8) << " handles for "
+                  << getLE(raw + 8, 8) << " records)" << std::endl;
+    } else {
+        header.records = getLE(raw + 8, 8);
+        header.handles = getLE(raw + 16, 8);
+        remaining = header.records;
+        buffer.resize(RECORDS_PER_CHUNK * RECORD_SIZE);
+        return;
+    }
+    std::fclose(file);
+    file = nullptr;
+}
+
+AllocTraceReader::~AllocTraceReader() {
+    if (file) std::fclose(file);
+}
+
+size_t AllocTraceReader::readBatch(AllocOp* out, size_t max) {
+    if (!file || remaining == 0) return 0;
+
+    size_t want = (size_t)std::min<uint64_t>(std::min(max, RECORDS_PER_CHUNK), remaining);
+    size_t got = std::fread(buffer.data(), RECORD_SIZE, want, file);
+    for (size_t i = 0; i < got; ++i) {
+        const unsigned char* p = buffer.data() + i * RECORD_SIZE;
+        out[i].op = (AllocOpType)std::min<unsigned char>(p[0], (unsigned char)AllocOpType::REALLOC);
+        out[i].handle = (uint32_t)getLE(p + 1, 4);
+        out[i].size = getLE(p + 5, 8);
+        out[i].timestamp = getLE(p + 13, 8);
+    }
+    // a truncated file ends the trace early
+    remaining = (got == want) ? remaining - got : 0;
+    return got;
+}
+
+void AllocationDriver::run(AllocTraceReader& reader) {
+    bool was_verbose = heap.isVerbose();
+    heap.setVerbose(false);
+    uint64_t handles = reader.getHeader().handles;
+    if (handles > block_ids.size()) block_ids.resize((size_t)std::min(handles, DENSE_HANDLES), -1);
+    uint64_t saved_limit = handle_limit;
+    handle_limit = handles;
+
+    std::vector<AllocOp> batch(RECORDS_PER_CHUNK);
+    auto start = std::chrono::steady_clock::now();
+    size_t n;
+    while ((n = reader.readBatch(batch.data(), batch.size())) > 0) {
+        applyBatch(batch.data(), n);
+    }
+    auto end = std::chrono::steady_clock::now();
+    stats.seconds += std::chrono::duration<double>(end - start).count();
+
+    handle_limit = saved_limit;
+    heap.setVerbose(was_verbose);
+}
+
+uint32_t AllocLogImporter::bind(unsigned long long key) {
+    uint32_t handle;
+    if (!free_handles.empty()) {
+        handle = free_handles.back();
+        free_handles.pop_back();
+    } else {
+        handle = next_handle++;
+    }
+    auto it = live.find(key);
+    if (it != live.end()) {
+        // pointer handed out twice without a free in between (lost free): recycle the old handle
+        free_handles.push_back(it->second);
+        it->second = handle;
+    } else {
+        live.emplace(key, handle);
+    }
+    return handle;
+}
+
+bool AllocLogImporter::release(unsigned long long key, uint32_t& handle) {
+    auto it = live.find(key);
+    if (it == live.end()) return false;
+    handle = it->second;
+    free_handles.push_back(handle);
+    live.erase(it);
+    return true;
+}
+
+bool AllocLogImporter::parseLine(const std::string& line, AllocOp& op) {
+    std::string text = line;
+    size_t hash = text.find('#');
+    if (hash != std::string::npos) text.erase(hash);
+
+    std::stringstream ss(text);
+    std::string first;
+    if (!(ss >> first)) return false;
+    op.timestamp = stats.lines;
+    uint64_t timestamp;
+    if (parseTimestamp(first, timestamp)) {
+        op.timestamp = timestamp;
+        std::getline(ss, text);
+    }
+
+    // call form: name(args) [= result]
+    size_t open_paren = std::string::npos;
+    std::string name;
+    for (const char* call : {"realloc(", "calloc(", "malloc(", "free("}) {
+        size_t pos = text.find(call);
+        if (pos != std::string::npos) {
+            open_paren = pos + std::strlen(call) - 1;
+            name.assign(call, std::strlen(call) - 1);
+            break;
+        }
+    }
+    if (open_paren != std::string::npos) {
+        size_t close_paren = text.find(')', open_paren);
+        if (close_paren == std::string::npos) return false;
+        std::vector<std::string> args;
+        std::stringstream arg_stream(text.substr(open_paren + 1, close_paren - open_paren - 1));
+        std::string arg;
+        while (std::getline(arg_stream, arg, ',')) args.push_back(arg);
+
+        unsigned long long result = 0;
+        size_t eq = text.find('=', close_paren);
+        bool has_result = eq != std::string::npos && parsePointer(text.substr(eq + 1), result);
+
+        unsigned long long a = 0, b = 0;
+        if (name == "free") {
+            if (args.size() != 1 || !parsePointer(args[0], a) || a == 0) return false;
+            if (!release(a, op.handle)) {
+                stats.unknown_frees++;
+                return false;
+            }
+            op.op = AllocOpType::FREE;
+            op.size = 0;
+            return true;
+        }
+        if (!has_result) return false;
+        if (name == "malloc") {
+            if (args.size() != 1 || !parsePointer(args[0], a) || result == 0) return false;
+            op.op = AllocOpType::MALLOC;
+            op.size = a;
+        } else if (name == "calloc") {
+            if (args.size() != 2 || !parsePointer(args[0], a) || !parsePointer(args[1], b) || result == 0) return false;
+            op.op = AllocOpType::MALLOC;
+            op.size = a * b;
+        } else { // realloc(ptr, size)
+            if (args.size() != 2 || !parsePointer(args[0], a) || !parsePointer(args[1], b)) return false;
+            uint32_t old_handle;
+            if (a != 0 && !release(a, old_handle)) {
+                stats.unknown_frees++;
+                a = 0; // treat as a fresh allocation
+            }
+            if (b == 0 || result == 0) {
+                // realloc(p, 0) frees p; a failed realloc leaves p live, which the log cannot tell apart
+                if (a == 0) return false;
+                op.op = AllocOpType::FREE;
+                op.handle = old_handle;
+                op.size = 0;
+                return true;
+            }
+            if (a == 0) {
+                op.op = AllocOpType::MALLOC;
+            } else {
+                // keep the handle: the old slot was just released, so bind() hands it back
+                op.op = AllocOpType::REALLOC;
+            }
+            op.size = b;
+        }
+        op.handle = bind(result);
+        return true;
+    }
+
+    // word form
+    std::stringstream words(text);
+    std::string command;
+    words >> command;
+    unsigned long long x = 0, y = 0;
+    std::string x_text, y_text;
+    words >> x_text >> y_text;
+    if (command == "malloc") {
+        if (!parseNumber(x_text, x)) return false;
+        if (y_text.empty()) {
+            y = next_sequential_id++;
+        } else if (!parseNumber(y_text, y)) {
+            return false;
+        }
+        op.op = AllocOpType::MALLOC;
+        op.size = x;
+        op.handle = bind(y);
+        return true;
+    }
+    if (command == "free") {
+        if (!parseNumber(x_text, x)) return false;
+        if (!release(x, op.handle)) {
+            stats.unknown_frees++;
+            return false;
+        }
+        op.op = AllocOpType::FREE;
+        op.size = 0;
+        return true;
+    }
+    if (command == "realloc") {
+        if (!parseNumber(x_text, x) || !parseNumber(y_text, y)) return false;
+        uint32_t old_handle;
+        op.op = release(x, old_handle) ? AllocOpType::REALLOC : AllocOpType::MALLOC;
+        op.size = y;
+        op.handle = bind(x);
+        return true;
+    }
+    return false;
+}
+
+bool AllocLogImporter::run(const std::string& text_path, const std::string& trace_path) {
+    std::ifstream in(text_path);
+    if (!in) {
+        std::cerr << "Error: Cannot open allocation log " << text_path << std::endl;
+        return false;
+    }
+    AllocTraceWriter writer;
+    if (!writer.open(trace_path)) return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        stats.lines++;
+        size_t start = line.find_first_not_of(" \t\r");
+        if (start == std::string::npos || line[start] == '#') continue;
+
+        AllocOp op;
+        if (parseLine(line, op)) {
+            writer.write(op);
+            stats.records++;
+        } else {
+            stats.skipped++;
+        }
+    }
+    writer.close();
+    return true;
+}
@@ -0,0 +1,543 @@
+#include "../../include/CompactTrace.h"
+#include "../../include/TraceReplay.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char MAGIC[4] = {'M', 'S', 'C', 'T'};
+const uint32_t VERSION = 1;
+const size_t HEADER_SIZE = 32;
+const size_t INDEX_ENTRY_SIZE = 24;
+const size_t CONVERT_BATCH = 1 << 16;
+
+// token tags (see CompactTrace.h)
+const uint64_t TAG_MASK = 7;
+const uint64_t TAG_ABSOLUTE = 3;
+const uint64_t TAG_RUN = 7;
+
+void putLE(unsigned char* p, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) p[i] = (unsigned char)(value >> (8 * i));
+}
+
+uint64_t getLE(const unsigned char* p, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) value |= (uint64_t)p[i] << (8 * i);
+    return value;
+}
+
+inline uint64_t zigzag(uint64_t delta) {
+    return (delta << 1) ^ (uint64_t)((int64_t)delta >> 63);
+}
+
+inline uint64_t unzigzag(uint64_t value) {
+    return (value >> 1) ^ (0 - (value & 1));
+}
+
+// false on a varint running past end or over 10 bytes
+inline bool getVarint(const unsigned char*& p, const unsigned char* end, uint64_t& value) {
+    // one-byte tokens dominate strided and local traces
+    if (p < end && *p < 0x80) {
+        value = *p++;
+        return true;
+    }
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        unsigned char byte = *p++;
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if (byte < 0x80) return true;
+    }
+    return false;
+}
+
+inline bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+inline int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// hex digits without prefix; false if there are none
+bool parseHex(const char*& p, unsigned long long& value) {
+    const char* start = p;
+    value = 0;
+    int d;
+    while ((d = hexValue(*p)) >= 0) {
+        value = (value << 4) | (unsigned)d;
+        ++p;
+    }
+    return p != start;
+}
+
+// Lackey: "I  0400d7d4,8" / " L 7ff000398,8" / " S ..." / " M ..."
+bool parseLackeyLine(const char* p, unsigned long long& address, AccessType& type) {
+    while (*p == ' ') ++p;
+    switch (*p) {
+        case 'I': type = AccessType::IFETCH; break;
+        case 'L': type = AccessType::LOAD; break;
+        case 'S':
+        case 'M': type = AccessType::STORE; break;
+        default: return false;
+    }
+    ++p;
+    if (*p != ' ') return false;
+    while (*p == ' ') ++p;
+    return parseHex(p, address) && *p == ',';
+}
+
+// pinatrace: "0x7f5a2c3b1e: R 0x7ffd4c8a10"
+bool parsePinLine(const char* p, unsigned long long& address, AccessType& type) {
+    const char* colon = std::strchr(p, ':');
+    if (!colon) return false;
+    p = colon + 1;
+    while (*p == ' ') ++p;
+    if (*p == 'R') {
+        type = AccessType::LOAD;
+    } else if (*p == 'W') {
+        type = AccessType::STORE;
+    } else {
+        return false;
+    }
+    ++p;
+    while (*p == ' ') ++p;
+    if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) p += 2;
+    return parseHex(p, address) && (*p == '\0' || isBlank(*p));
+}
+
+// valgrind banner lines ("==123== ...") and comments carry no accesses
+bool isChatter(const char* p) {
+    while (isBlank(*p)) ++p;
+    return *p == '\0' || *p == '#' || (p[0] == '=' && p[1] == '=') || (p[0] == '-' && p[1] == '-');
+}
+
+TraceFormat detectFormat(const std::string& path) {
+    FILE* in = std::fopen(path.c_str(), "rb");
+    if (!in) return TraceFormat::TEXT;
+    char line[4096];
+    TraceFormat format = TraceFormat::TEXT;
+    while (std::fgets(line, sizeof(line), in)) {
+        if (isChatter(line)) continue;
+        unsigned long long address;
+        AccessType type;
+        if (parseLackeyLine(line, address, type)) {
+            format = TraceFormat::LACKEY;
+        } else if (parsePinLine(line, address, type)) {
+            format = TraceFormat::PIN;
+        }
+        break;
+    }
+    std::fclose(in);
+    return format;
+}
+
+uint64_t fileSize(const std::string& path) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    return in ? (uint64_t)in.tellg() : 0;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Writer
+// ---------------------------------------------------------------------------
+
+CompactTraceWriter::CompactTraceWriter()
+    : file(nullptr), total_accesses(0), file_offset(0),
+      block_accesses(0), prev_address(0), last_delta(0), last_type(AccessType::LOAD), has_last(false), run(0) {}
+
+CompactTraceWriter::~CompactTraceWriter() {
+    close();
+}
+
+bool CompactTraceWriter::open(const std::string& path) {
+    close();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cout << "Error: Cannot create compact trace " << path << std::endl;
+        return false;
+    }
+    unsigned char placeholder[HEADER_SIZE] = {0};
+    std::fwrite(placeholder, 1, HEADER_SIZE, file);
+    file_offset = HEADER_SIZE;
+    total_accesses = 0;
+    index.clear();
+    block.clear();
+    block_accesses = 0;
+    prev_address = 0;
+    has_last = false;
+    run = 0;
+    return true;
+}
+
+void CompactTraceWriter::putVarint(uint64_t value) {
+    while (value >= 0x80) {
+        block.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    block.push_back((unsigned char)value);
+}
+
+void CompactTraceWriter::flushRun() {
+    if (run == 0) return;
+    putVarint((run << 3) | TAG_RUN);
+    run = 0;
+}
+
+void CompactTraceWriter::append(unsigned long long address, AccessType type) {
+    if (!file) return;
+
+    uint64_t delta = address - prev_address;
+    if (has_last && delta == last_delta && type == last_type) {
+        run++;
+    } else {
+        flushRun();
+        uint64_t zz = zigzag(delta);
+        if ((zz >> 62) == 0) {
+            putVarint((zz << 2) | (uint64_t)type);
+        } else {
+            putVarint(((uint64_t)type << 3) | TAG_ABSOLUTE);
+            putVarint(address);
+        }
+        last_delta = delta;
+        last_type = type;
+        has_last = true;
+    }
+    prev_address = address;
+    total_accesses++;
+
+    if (++block_accesses == BLOCK_ACCESSES) flushBlock();
+}
+
+void CompactTraceWriter::flushBlock() {
+    flushRun();
+    if (block_accesses == 0) return;
+
+    IndexEntry entry;
+    entry.offset = file_offset;
+    entry.first_access = total_accesses - block_accesses;
+    entry.bytes = (uint32_t)block.size();
+    entry.accesses = block_accesses;
+    index.push_back(entry);
+
+    std::fwrite(block.data(), 1, block.size(), file);
+    file_offset += block.size();
+
+    block.clear();
+    block_accesses = 0;
+    prev_address = 0;
+    has_last = false;
+}
+
+uint64_t CompactTraceWriter::close() {
+    if (!file) return 0;
+    flushBlock();
+
+    uint64_t index_offset = file_offset;
+    std::vector<unsigned char> raw(index.size() * INDEX_ENTRY_SIZE);
+    for (size_t i = 0; i < index.size(); ++i) {
+        unsigned char* p = raw.data() + i * INDEX_ENTRY_SIZE;
+        putLE(p, index[i].offset, 8);
+        putLE(p + 8, index[i].first_access, 8);
+        putLE(p + 16, index[i].bytes, 4);
+        putLE(p + 20, index[i].accesses, 4);
+    }
+    if (!raw.empty()) std::fwrite(raw.data(), 1, raw.size(), file);
+
+    unsigned char header[HEADER_SIZE];
+    std::memcpy(header, MAGIC, 4);
+    putLE(header + 4, VERSION, 4);
+    putLE(header + 8, total_accesses, 8);
+    putLE(header + 16, index.size(), 8);
+    putLE(header + 24, index_offset, 8);
+    std::fseek(file, 0, SEEK_SET);
+    std::fwrite(header, 1, HEADER_SIZE, file);
+    std::fclose(file);
+    file = nullptr;
+
+    return index_offset + raw.size();
+}
+
+// ---------------------------------------------------------------------------
+// Reader
+// ---------------------------------------------------------------------------
+
+bool CompactTraceReader::isCompactTrace(const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    char magic[4];
+    bool match = std::fread(magic, 1, 4, f) == 4 && std::memcmp(magic, MAGIC, 4) == 0;
+    std::fclose(f);
+    return match;
+}
+
+CompactTraceReader::CompactTraceReader(const std::string& path)
+    : data(nullptr), size(0), accesses(0), blocks(0), index(nullptr),
+      next_block(0), pos(nullptr), end(nullptr), left_in_block(0),
+      prev_address(0), last_delta(0), last_type(AccessType::LOAD), run(0), corrupt(false)
+{
+    mapFile(path);
+    if (!data) return;
+
+    if (size < HEADER_SIZE || std::memcmp(data, MAGIC, 4) != 0 || getLE(data + 4, 4) != VERSION) {
+        std::cout << "Error: " << path << " is not a compact trace (version " << VERSION << ")" << std::endl;
+        unmapFile();
+        return;
+    }
+    accesses = getLE(data + 8, 8);
+    blocks = getLE(data + 16, 8);
+    uint64_t index_offset = getLE(data + 24, 8);
+    if (index_offset < HEADER_SIZE || index_offset > size || blocks > (size - index_offset) / INDEX_ENTRY_SIZE) {
+        std::cout << "Error: Truncated compact trace " << path << std::endl;
+        unmapFile();
+        return;
+    }
+    index = data + index_offset;
+}
+
+CompactTraceReader::~CompactTraceReader() {
+    unmapFile();
+}
+
+void CompactTraceReader::mapFile(const std::string& path) {
+#ifdef _WIN32
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        std::cout << "Error: Cannot open compact trace " << path << std::endl;
+        return;
+    }
+    fallback.resize((size_t)in.tellg());
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(fallback.data()), fallback.size());
+    if (fallback.empty()) return;
+    data = fallback.data();
+    size = fallback.size();
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cout << "Error: Cannot open compact trace " << path << std::endl;
+        return;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        void* p = ::mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            data = static_cast<const unsigned char*>(p);
+            size = (size_t)st.st_size;
+            ::madvise(p, size, MADV_SEQUENTIAL);
+        }
+    }
+    ::close(fd);
+    if (!data) std::cout << "Error: Cannot map compact trace " << path << std::endl;
+#endif
+}
+
+void CompactTraceReader::unmapFile() {
+#ifdef _WIN32
+    fallback.clear();
+    fallback.shrink_to_fit();
+#else
+    if (data) ::munmap(const_cast<unsigned char*>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+    index = nullptr;
+}
+
+bool CompactTraceReader::enterBlock(uint64_t b) {
+    if (b >= blocks) return false;
+    const unsigned char* entry = index + b * INDEX_ENTRY_SIZE;
+    uint64_t offset = getLE(entry, 8);
+    uint64_t bytes = getLE(entry + 16, 4);
+    if (offset < HEADER_SIZE || offset > size || bytes > size - offset) {
+        corrupt = true;
+        return false;
+    }
+    pos = data + offset;
+    end = pos + bytes;
+    left_in_block = (uint32_t)getLE(entry + 20, 4);
+    next_block = b + 1;
+    prev_address = 0;
+    last_delta = 0;
+    last_type = AccessType::LOAD;
+    run = 0;
+    return true;
+}
+
+bool CompactTraceReader::seek(uint64_t n) {
+    if (!data) return false;
+    corrupt = false;
+    run = 0;
+    left_in_block = 0;
+    next_block = blocks;
+    if (n >= accesses) return n == accesses;
+
+    // last block whose first access is <= n
+    uint64_t lo = 0, hi = blocks;
+    while (hi - lo > 1) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (getLE(index + mid * INDEX_ENTRY_SIZE + 8, 8) <= n) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    if (!enterBlock(lo)) return false;
+
+    uint64_t skip = n - getLE(index + lo * INDEX_ENTRY_SIZE + 8, 8);
+    unsigned long long scratch[256];
+    while (skip > 0) {
+        size_t got = readBatch(scratch, nullptr, (size_t)std::min<uint64_t>(skip, 256));
+        if (got == 0) return false;
+        skip -= got;
+    }
+    return true;
+}
+
+size_t CompactTraceReader::readBatch(unsigned long long* out, AccessType* types, size_t max) {
+    if (!data || corrupt) return 0;
+
+    size_t count = 0;
+    while (count < max) {
+        if (run > 0) {
+            size_t n = (size_t)std::min<uint64_t>(run, max - count);
+            unsigned long long addr = prev_address;
+            for (size_t i = 0; i < n; ++i) {
+                addr += last_delta;
+                out[count + i] = addr;
+            }
+            if (types) std::fill(types + count, types + count + n, last_type);
+            prev_address = addr;
+            run -= n;
+            left_in_block -= (uint32_t)n;
+            count += n;
+            continue;
+        }
+        if (left_in_block == 0) {
+            if (!enterBlock(next_block)) break;
+            continue;
+        }
+
+        uint64_t token;
+        if (!getVarint(pos, end, token)) {
+            corrupt = true;
+            break;
+        }
+        uint64_t tag = token & 3;
+        if (tag != 3) {
+            last_delta = unzigzag(token >> 2);
+            last_type = (AccessType)tag;
+            prev_address += last_delta;
+        } else if ((token & TAG_MASK) == TAG_ABSOLUTE) {
+            uint64_t address;
+            if ((token >> 3) > 2 || !getVarint(pos, end, address)) {
+                corrupt = true;
+                break;
+            }
+            last_delta = address - prev_address;
+            last_type = (AccessType)(token >> 3);
+            prev_address = address;
+        } else {
+            run = token >> 3;
+            if (run == 0 || run > left_in_block) {
+                corrupt = true;
+                break;
+            }
+            continue;
+        }
+        out[count] = prev_address;
+        if (types) types[count] = last_type;
+        count++;
+        left_in_block--;
+    }
+    if (corrupt) std::cerr << "Error: Corrupt compact trace block " << (next_block - 1) << std::endl;
+    return count;
+}
+
+// ---------------------------------------------------------------------------
+// Converter
+// ---------------------------------------------------------------------------
+
+bool parseTraceFormat(const std::string& name, TraceFormat& format) {
+    if (name == "auto") {
+        format = TraceFormat::AUTO;
+    } else if (name == "text") {
+        format = TraceFormat::TEXT;
+    } else if (name == "lackey") {
+        format = TraceFormat::LACKEY;
+    } else if (name == "pin") {
+        format = TraceFormat::PIN;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool convertTrace(const std::string& in_path, const std::string& out_path, TraceFormat format, TraceConvertStats& stats) {
+    stats = TraceConvertStats();
+    if (format == TraceFormat::AUTO) format = detectFormat(in_path);
+
+    CompactTraceWriter writer;
+
+    if (format == TraceFormat::TEXT) {
+        TraceReader reader(in_path);
+        if (!reader.isOpen()) {
+            std::cout << "Error: Cannot open trace file " << in_path << std::endl;
+            return false;
+        }
+        if (!writer.open(out_path)) return false;
+        std::vector<unsigned long long> batch(CONVERT_BATCH);
+        std::vector<AccessType> types(CONVERT_BATCH);
+        size_t n;
+        while ((n = reader.readBatch(batch.data(), types.data(), batch.size())) > 0) {
+            for (size_t i = 0; i < n; ++i) writer.append(batch[i], types[i]);
+        }
+        stats.skipped = reader.getMalformedLines();
+        stats.lines = writer.getAccessCount() + stats.skipped;
+    } else {
+        FILE* in = std::fopen(in_path.c_str(), "rb");
+        if (!in) {
+            std::cout << "Error: Cannot open trace file " << in_path << std::endl;
+            return false;
+        }
+        if (!writer.open(out_path)) {
+            std::fclose(in);
+            return false;
+        }
+        std::vector<char> io_buffer(1 << 20);
+        std::setvbuf(in, io_buffer.data(), _IOFBF, io_buffer.size());
+
+        char line[4096];
+        bool (*parse)(const char*, unsigned long long&, AccessType&) =
+            (format == TraceFormat::LACKEY) ? parseLackeyLine : parsePinLine;
+        while (std::fgets(line, sizeof(line), in)) {
+            if (isChatter(line)) continue;
+            stats.lines++;
+            unsigned long long address;
+            AccessType type;
+            if (parse(line, address, type)) {
+                writer.append(address, type);
+            } else {
+                stats.skipped++;
+            }
+        }
+        std::fclose(in);
+    }
+
+    stats.accesses = writer.getAccessCount();
+    stats.output_bytes = writer.close();
+    stats.input_bytes = fileSize(in_path);
+    return true;
+}
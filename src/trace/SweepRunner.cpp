@@ -0,0 +1,290 @@
+#include "../../include/SweepRunner.h"
+#include "../../include/TimingModel.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+bool parsePolicy(const std::string& name, ReplacementPolicy& policy) {
+    if (name == "fifo") {
+        policy = ReplacementPolicy::FIFO;
+    } else if (name == "lru") {
+        policy = ReplacementPolicy::LRU;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool isPagePolicy(const std::string& name) {
+    static const char* names[] = {"fifo", "lru", "clock", "second_chance", "2q", "arc"};
+    return std::find(std::begin(names), std::end(names), name) != std::end(names);
+}
+
+std::string describe(const CacheConfig& c) {
+    std::ostringstream out;
+    out << c.size << "/" << c.block_size << "/" << c.associativity << " "
+        << (c.policy == ReplacementPolicy::LRU ? "lru" : "fifo");
+    return out.str();
+}
+
+std::string describe(const VMConfig& v) {
+    if (v.phys_size == 0) return "off";
+    std::ostringstream out;
+    out << (v.phys_size / v.page_size) << "x" << v.page_size << " " << v.policy;
+    return out.str();
+}
+
+double percent(size_t part, size_t whole) {
+    return whole ? 100.0 * part / whole : 0.0;
+}
+
+} // namespace
+
+SweepRunner::SweepRunner() : seconds(0.0), accesses(0) {}
+
+bool SweepRunner::loadGrid(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Error: Cannot open sweep config " << path << std::endl;
+        return false;
+    }
+
+    std::vector<CacheConfig> l1s, l2s;
+    std::vector<InclusionPolicy> inclusions;
+    std::vector<VMConfig> vms;
+    std::string line;
+    size_t line_no = 0;
+    while (std::getline(in, line)) {
+        line_no++;
+        line = line.substr(0, line.find('#'));
+        std::stringstream ss(line);
+        std::string key;
+        if (!(ss >> key)) continue;
+
+        bool ok = false;
+        if (key == "l1" || key == "l2") {
+            CacheConfig c;
+            std::string policy;
+            ok = (ss >> c.size >> c.block_size >> c.associativity >> policy) && parsePolicy(policy, c.policy)
+                 && c.block_size > 0 && c.associativity > 0 && c.size >= c.block_size * c.associativity;
+            if (ok) (key == "l1" ? l1s : l2s).push_back(c);
+        } else if (key == "inclusion") {
+            std::string name;
+            InclusionPolicy inclusion;
+            ok = (ss >> name) && parseInclusionPolicy(name, inclusion);
+            if (ok) inclusions.push_back(inclusion);
+        } else if (key == "vm") {
+            VMConfig v{0, 64, "fifo"};
+            std::string first;
+            if (ss >> first) {
+                if (first == "off") {
+                    ok = true;
+                } else {
+                    try {
+                        v.phys_size = std::stoull(first);
+                        ok = v.phys_size > 0;
+                    } catch (...) {
+                        ok = false;
+                    }
+                    if (ok && ss >> v.page_size) {
+                        ss >> v.policy;
+                        ok = v.page_size > 0 && isPagePolicy(v.policy);
+                    }
+                }
+            }
+            if (ok) vms.push_back(v);
+        }
+        if (!ok) {
+            std::cerr << "Error: " << path << ":" << line_no << ": invalid sweep entry '" << line << "'" << std::endl;
+            return false;
+        }
+    }
+
+    // components not listed keep the simulator defaults
+    if (l1s.empty()) l1s.push_back({1024, 64, 2, ReplacementPolicy::FIFO});
+    if (l2s.empty()) l2s.push_back({4096, 64, 4, ReplacementPolicy::FIFO});
+    if (inclusions.empty()) inclusions.push_back(InclusionPolicy::NINE);
+    if (vms.empty()) vms.push_back({0, 64, "fifo"});
+
+    grid.clear();
+    for (const CacheConfig& l1 : l1s) {
+        for (const CacheConfig& l2 : l2s) {
+            for (InclusionPolicy inclusion : inclusions) {
+                if (inclusion == InclusionPolicy::EXCLUSIVE && l1.block_size != l2.block_size) {
+                    std::cerr << "Error: " << path << ": exclusive hierarchies need equal L1/L2 block sizes" << std::endl;
+                    return false;
+                }
+                if (inclusion == InclusionPolicy::INCLUSIVE && l2.block_size < l1.block_size) {
+                    std::cerr << "Error: " << path << ": inclusive hierarchies need an L2 block size of at least L1's"
+                              << std::endl;
+                    return false;
+                }
+                for (const VMConfig& vm : vms) {
+                    grid.push_back({l1, l2, inclusion, vm});
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool SweepRunner::createInstances() {
+    instances.clear();
+    instances.resize(grid.size());
+    for (size_t i = 0; i < grid.size(); ++i) {
+        Instance& inst = instances[i];
+        const SweepConfig& c = grid[i];
+        inst.config = c;
+        inst.caches = std::make_unique<CacheHierarchy>();
+        if (!inst.caches->addLevel(c.l1.size, c.l1.block_size, c.l1.associativity, c.l1.policy)
+            || !inst.caches->addLevel(c.l2.size, c.l2.block_size, c.l2.associativity, c.l2.policy)
+            || !inst.caches->setInclusion(c.inclusion)) {
+            std::cerr << "Error: Sweep configuration " << i + 1 << " is not a valid cache hierarchy" << std::endl;
+            instances.clear();
+            return false;
+        }
+        if (c.vm.phys_size > 0) {
+            inst.vm = std::make_unique<VirtualMemoryManager>(c.vm.phys_size, c.vm.page_size, 0, false);
+            inst.vm->setReplacementPolicy(c.vm.policy);
+        }
+        inst.replayer = std::make_unique<TraceReplayer>(inst.vm.get(), *inst.caches);
+    }
+    return true;
+}
+
+bool SweepRunner::run(const std::string& trace_path, size_t threads) {
+    TraceReader reader(trace_path);
+    if (!reader.isOpen()) {
+        std::cerr << "Error: Cannot open trace file " << trace_path << std::endl;
+        return false;
+    }
+
+    if (!createInstances()) return false;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, std::max<size_t>(instances.size(), 1));
+
+    // double buffer: workers simulate batch[current] while this thread decodes the other one
+    std::vector<unsigned long long> batch[2] = {
+        std::vector<unsigned long long>(BATCH_SIZE), std::vector<unsigned long long>(BATCH_SIZE)};
+    std::vector<AccessType> types[2] = {std::vector<AccessType>(BATCH_SIZE), std::vector<AccessType>(BATCH_SIZE)};
+    int current = 0;
+    size_t count = 0;
+
+    std::mutex mutex;
+    std::condition_variable work_ready, work_done;
+    size_t generation = 0;   // bumped for every published batch
+    size_t finished = 0;     // workers done with the current generation
+    bool stop = false;
+    std::atomic<size_t> next_instance(0);
+
+    auto worker = [&]() {
+        size_t seen = 0;
+        while (true) {
+            const unsigned long long* data;
+            const AccessType* data_types;
+            size_t n;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                work_ready.wait(lock, [&] { return stop || generation != seen; });
+                if (stop) return;
+                seen = generation;
+                data = batch[current].data();
+                data_types = types[current].data();
+                n = count;
+            }
+            size_t i;
+            while ((i = next_instance.fetch_add(1, std::memory_order_relaxed)) < instances.size()) {
+                instances[i].replayer->processBatch(data, data_types, n);
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (++finished == threads) work_done.notify_one();
+            }
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> pool;
+    for (size_t t = 0; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+
+    count = reader.readBatch(batch[current].data(), types[current].data(), BATCH_SIZE);
+    while (count > 0) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = 0;
+            next_instance.store(0, std::memory_order_relaxed);
+            generation++;
+        }
+        work_ready.notify_all();
+        accesses += count;
+
+        size_t next_count = reader.readBatch(batch[current ^ 1].data(), types[current ^ 1].data(), BATCH_SIZE);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        work_done.wait(lock, [&] { return finished == threads; });
+        current ^= 1;
+        count = next_count;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    work_ready.notify_all();
+    for (std::thread& t : pool) {
+        t.join();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    seconds = std::chrono::duration<double>(end - start).count();
+
+    if (reader.getMalformedLines() > 0) {
+        std::cerr << "Warning: Skipped " << reader.getMalformedLines() << " malformed trace lines." << std::endl;
+    }
+    std::cout << "Sweep: " << instances.size() << " configurations, " << accesses << " accesses, "
+              << threads << " threads, " << std::fixed << std::setprecision(3) << seconds << " s\n";
+    return true;
+}
+
+void SweepRunner::printResults() const {
+    std::cout << std::left
+              << std::setw(4) << "#" << std::setw(18) << "L1" << std::setw(18) << "L2" << std::setw(15) << "Inclusion"
+              << std::setw(18) << "VM"
+              << std::right << std::setw(10) << "L1 miss%" << std::setw(10) << "L2 miss%"
+              << std::setw(14) << "Mem Accesses" << std::setw(12) << "Faults" << std::setw(12) << "AMAT" << "\n";
+
+    const TimingModel timing; // default latencies
+
+    for (size_t i = 0; i < instances.size(); ++i) {
+        const Instance& inst = instances[i];
+        const CacheLevel& l1 = inst.caches->getLevel(0);
+        const CacheLevel& l2 = inst.caches->getLevel(1);
+        size_t l1_total = l1.getHits() + l1.getMisses();
+        size_t l2_total = l2.getHits() + l2.getMisses();
+        std::cout << std::left
+                  << std::setw(4) << i << std::setw(18) << describe(inst.config.l1)
+                  << std::setw(18) << describe(inst.config.l2) << std::setw(15) << inclusionPolicyName(inst.config.inclusion)
+                  << std::setw(18) << describe(inst.config.vm)
+                  << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(10) << percent(l1.getMisses(), l1_total)
+                  << std::setw(10) << percent(l2.getMisses(), l2_total)
+                  << std::setw(14) << inst.replayer->getStats().memory_accesses;
+        if (inst.vm) {
+            std::cout << std::setw(12) << inst.vm->getPageFaults();
+        } else {
+            std::cout << std::setw(12) << "-";
+        }
+        std::cout << std::setw(12) << timing.amat(*inst.caches, inst.vm.get()) << "\n";
+    }
+}
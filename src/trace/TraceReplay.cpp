@@ -0,0 +1,292 @@
+#include "../../include/TraceReplay.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+const size_t READ_CHUNK = 1 << 20;
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline int digitValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return 99;
+}
+
+// Same base detection as std::stoull(str, nullptr, 0), without the allocation.
+// Returns false if the token is not a complete number.
+bool parseAddress(const char*& p, const char* end, unsigned long long& value) {
+    unsigned base = 10;
+    if (p < end && *p == '0') {
+        if (p + 1 < end && (p[1] == 'x' || p[1] == 'X')) {
+            base = 16;
+            p += 2;
+        } else {
+            base = 8;
+        }
+    }
+
+    const char* digits_start = p;
+    value = 0;
+    while (p < end) {
+        int d = digitValue(*p);
+        if (d >= (int)base) break;
+        value = value * base + d;
+        ++p;
+    }
+    if (p == digits_start) return false;
+    return p == end || isSpace(*p) || *p == '#';
+}
+
+bool equalsIgnoreCase(const char* a, const char* b, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        if (std::tolower((unsigned char)a[i]) != std::tolower((unsigned char)b[i])) return false;
+    }
+    return true;
+}
+
+// Optional access-type token in front of the address. Returns false if the token is not a type.
+bool parseType(const char*& p, const char* end, AccessType& type) {
+    const char* token_end = p;
+    while (token_end < end && !isSpace(*token_end)) ++token_end;
+    size_t len = token_end - p;
+    if (len == 0 || token_end == end) return false;
+
+    auto is = [p, len](const char* word) { return std::strlen(word) == len && equalsIgnoreCase(p, word, len); };
+    if (is("r") || is("l") || is("load")) {
+        type = AccessType::LOAD;
+    } else if (is("w") || is("s") || is("m") || is("store")) {
+        type = AccessType::STORE;
+    } else if (is("i") || is("ifetch")) {
+        type = AccessType::IFETCH;
+    } else {
+        return false;
+    }
+    p = token_end;
+    while (p < end && isSpace(*p)) ++p;
+    return true;
+}
+
+} // namespace
+
+TraceReader::TraceReader(const std::string& path)
+    : file(nullptr), buffer(READ_CHUNK), pos(0), len(0), at_eof(false), malformed_lines(0)
+{
+    if (CompactTraceReader::isCompactTrace(path)) {
+        compact = std::make_unique<CompactTraceReader>(path);
+        return;
+    }
+    file = std::fopen(path.c_str(), "rb");
+}
+
+TraceReader::~TraceReader() {
+    if (file) std::fclose(file);
+}
+
+bool TraceReader::refill() {
+    if (at_eof) return false;
+
+    // keep the partial line at the front of the buffer
+    if (pos > 0) {
+        std::memmove(buffer.data(), buffer.data() + pos, len - pos);
+        len -= pos;
+        pos = 0;
+    }
+    // a single line longer than the buffer: grow it
+    if (len == buffer.size()) {
+        buffer.resize(buffer.size() * 2);
+    }
+
+    size_t n = std::fread(buffer.data() + len, 1, buffer.size() - len, file);
+    if (n == 0) {
+        at_eof = true;
+        return false;
+    }
+    len += n;
+    return true;
+}
+
+const char* TraceReader::nextLine(size_t& line_len) {
+    while (true) {
+        if (pos < len) {
+            const char* start = buffer.data() + pos;
+            const char* nl = static_cast<const char*>(std::memchr(start, '\n', len - pos));
+            if (nl) {
+                line_len = nl - start;
+                pos += line_len + 1;
+                return start;
+            }
+            if (at_eof) {
+                // last line without trailing newline
+                line_len = len - pos;
+                pos = len;
+                return start;
+            }
+        } else if (at_eof) {
+            return nullptr;
+        }
+        if (!refill() && pos >= len) return nullptr;
+    }
+}
+
+size_t TraceReader::readBatch(unsigned long long* out, AccessType* types, unsigned* cores, size_t max) {
+    if (compact) {
+        if (cores) {
+            std::cerr << "Error: Compact traces carry no core ids." << std::endl;
+            return 0;
+        }
+        return compact->readBatch(out, types, max);
+    }
+    if (!file) return 0;
+
+    size_t count = 0;
+    size_t line_len;
+    const char* line;
+    while (count < max && (line = nextLine(line_len)) != nullptr) {
+        const char* p = line;
+        const char* end = line + line_len;
+
+        while (p < end && isSpace(*p)) ++p;
+        if (p == end || *p == '#') continue;
+
+        unsigned core = 0;
+        if (cores) {
+            const char* digits_start = p;
+            while (p < end && *p >= '0' && *p <= '9') core = core * 10 + (*p++ - '0');
+            if (p == digits_start || p == end || !isSpace(*p)) {
+                malformed_lines++;
+                continue;
+            }
+            while (p < end && isSpace(*p)) ++p;
+        }
+
+        // optional "access" keyword from interactive scripts
+        if (end - p > 6 && std::memcmp(p, "access", 6) == 0 && isSpace(p[6])) {
+            p += 6;
+            while (p < end && isSpace(*p)) ++p;
+        }
+
+        AccessType type = AccessType::LOAD;
+        if (p < end && !(*p >= '0' && *p <= '9')) parseType(p, end, type);
+
+        unsigned long long addr;
+        if (!parseAddress(p, end, addr)) {
+            malformed_lines++;
+            continue;
+        }
+        if (types) types[count] = type;
+        if (cores) cores[count] = core;
+        out[count++] = addr;
+    }
+    return count;
+}
+
+TraceReplayer::TraceReplayer(VirtualMemoryManager* _vm, CacheHierarchy& _caches)
+    : vm(_vm), caches(_caches), sampler(nullptr) {}
+
+void TraceReplayer::processRange(const unsigned long long* addresses, const AccessType* types, size_t count) {
+    const size_t memory = caches.numLevels();
+    size_t memory_accesses = 0;
+    size_t stores = 0;
+    for (size_t i = 0; i < count; ++i) {
+        AccessType type = types ? types[i] : AccessType::LOAD;
+        bool is_write = (type == AccessType::STORE);
+        unsigned long long p_addr = vm ? vm->translate(addresses[i], is_write) : addresses[i];
+        if (caches.access(p_addr, type) == memory) {
+            memory_accesses++;
+        }
+        stores += is_write;
+    }
+    stats.accesses += count;
+    stats.memory_accesses += memory_accesses;
+    stats.stores += stores;
+}
+
+void TraceReplayer::processBatch(const unsigned long long* addresses, const AccessType* types, size_t count) {
+    if (!sampler) {
+        processRange(addresses, types, count);
+        return;
+    }
+    // split at interval boundaries so every row sees exactly N more accesses
+    size_t done = 0;
+    while (done < count) {
+        size_t n = (size_t)std::min<unsigned long long>(count - done, sampler->untilNextSample());
+        processRange(addresses + done, types ? types + done : nullptr, n);
+        sampler->advance(n, &caches, vm, nullptr);
+        done += n;
+    }
+}
+
+bool TraceReplayer::run(const std::string& path) {
+    TraceReader reader(path);
+    if (!reader.isOpen()) {
+        std::cerr << "Error: Cannot open trace file " << path << std::endl;
+        return false;
+    }
+
+    // per-access messages (page faults, evictions) would dominate the run time
+    bool vm_was_verbose = vm ? vm->isVerbose() : false;
+    if (vm) vm->setVerbose(false);
+
+    std::vector<unsigned long long> batch(BATCH_SIZE);
+    std::vector<AccessType> types(BATCH_SIZE);
+    auto start = std::chrono::steady_clock::now();
+
+    size_t n;
+    while ((n = reader.readBatch(batch.data(), types.data(), batch.size())) > 0) {
+        processBatch(batch.data(), types.data(), n);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    stats.seconds += std::chrono::duration<double>(end - start).count();
+
+    if (vm) vm->setVerbose(vm_was_verbose);
+
+    if (reader.getMalformedLines() > 0) {
+        std::cerr << "Warning: Skipped " << reader.getMalformedLines() << " malformed trace lines." << std::endl;
+    }
+    return true;
+}
+
+void TraceReplayer::run(AddressGenerator& generator, size_t count) {
+    bool vm_was_verbose = vm ? vm->isVerbose() : false;
+    if (vm) vm->setVerbose(false);
+
+    std::vector<unsigned long long> batch(std::min<size_t>(count, BATCH_SIZE));
+    std::vector<AccessType> types(batch.size());
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t done = 0; done < count;) {
+        size_t n = std::min(count - done, batch.size());
+        generator.fill(batch.data(), types.data(), n);
+        processBatch(batch.data(), types.data(), n);
+        done += n;
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    stats.seconds += std::chrono::duration<double>(end - start).count();
+
+    if (vm) vm->setVerbose(vm_was_verbose);
+}
+
+void TraceReplayer::printStats() const {
+    double rate = (stats.seconds > 0.0) ? stats.accesses / stats.seconds : 0.0;
+
+    std::cout << "Replay Statistics:\n"
+              << "  Accesses:        " << stats.accesses << "\n"
+              << "  Stores:          " << stats.stores << "\n"
+              << "  Memory Accesses: " << stats.memory_accesses << "\n";
+    // wall-clock figures go to stderr so redirected test logs stay reproducible
+    std::cerr << "  Elapsed:         " << std::fixed << std::setprecision(3) << stats.seconds << " s"
+              << " (" << std::setprecision(2) << rate / 1e6 << " M accesses/s)" << std::endl;
+    if (vm) vm->printStats();
+    caches.printStats();
+}
@@ -0,0 +1,451 @@
+#include "../../include/Workload.h"
+#include "../../include/Metrics.h"
+#include "../buddy/BuddyUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+const size_t ALLOC_BATCH = 1 << 16;
+
+// log1p(x) / x and expm1(x) / x, accurate near 0
+double helper1(double x) {
+    return std::fabs(x) > 1e-8 ? std::log1p(x) / x : 1.0 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+}
+
+double helper2(double x) {
+    return std::fabs(x) > 1e-8 ? std::expm1(x) / x : 1.0 + x * 0.5 * (1.0 + x / 3.0 * (1.0 + 0.25 * x));
+}
+
+// "4096", "64K", "16M", "1G"
+bool parseSize(const std::string& text, unsigned long long& value) {
+    if (text.empty()) return false;
+    size_t pos = 0;
+    try {
+        value = std::stoull(text, &pos, 0);
+    } catch (...) {
+        return false;
+    }
+    if (pos == text.size()) return true;
+    if (pos + 1 != text.size()) return false;
+    switch (text[pos]) {
+        case 'k': case 'K': value <<= 10; return true;
+        case 'm': case 'M': value <<= 20; return true;
+        case 'g': case 'G': value <<= 30; return true;
+        default: return false;
+    }
+}
+
+bool parseDouble(const std::string& text, double& value) {
+    try {
+        size_t pos = 0;
+        value = std::stod(text, &pos);
+        return pos == text.size();
+    } catch (...) {
+        return false;
+    }
+}
+
+bool splitOption(const std::string& option, std::string& key, std::string& value) {
+    size_t eq = option.find('=');
+    if (eq == std::string::npos || eq == 0) {
+        std::cout << "Error: Expected key=value, got '" << option << "'" << std::endl;
+        return false;
+    }
+    key = option.substr(0, eq);
+    value = option.substr(eq + 1);
+    return true;
+}
+
+bool badValue(const std::string& key, const std::string& value) {
+    std::cout << "Error: Invalid value '" << value << "' for " << key << std::endl;
+    return false;
+}
+
+} // namespace
+
+ZipfSampler::ZipfSampler(uint64_t _n, double _alpha) : n(std::max<uint64_t>(_n, 1)), alpha(_alpha) {
+    h_integral_x1 = hIntegral(1.5) - 1.0;
+    h_integral_n = hIntegral(n + 0.5);
+    s = 2.0 - hIntegralInverse(hIntegral(2.5) - h(2.0));
+    if (n <= ALIAS_LIMIT) buildAliasTable();
+}
+
+// Vose's alias method: every column holds at most two ranks and is picked uniformly
+void ZipfSampler::buildAliasTable() {
+    std::vector<double> scaled(n);
+    double total = 0.0;
+    for (uint64_t i = 0; i < n; ++i) {
+        scaled[i] = h((double)(i + 1));
+        total += scaled[i];
+    }
+
+    std::vector<uint32_t> small, large;
+    for (uint64_t i = 0; i < n; ++i) {
+        scaled[i] *= n / total;
+        (scaled[i] < 1.0 ? small : large).push_back((uint32_t)i);
+    }
+
+    alias_prob.assign(n, 1.0f);
+    alias_index.resize(n);
+    for (uint64_t i = 0; i < n; ++i) alias_index[i] = (uint32_t)i;
+    while (!small.empty() && !large.empty()) {
+        uint32_t less = small.back();
+        small.pop_back();
+        uint32_t more = large.back();
+        alias_prob[less] = (float)scaled[less];
+        alias_index[less] = more;
+        scaled[more] -= 1.0 - scaled[less];
+        if (scaled[more] < 1.0) {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+    // leftovers are 1.0 up to rounding
+}
+
+double ZipfSampler::h(double x) const {
+    return std::exp(-alpha * std::log(x));
+}
+
+double ZipfSampler::hIntegral(double x) const {
+    double log_x = std::log(x);
+    return helper2((1.0 - alpha) * log_x) * log_x;
+}
+
+double ZipfSampler::hIntegralInverse(double x) const {
+    double t = x * (1.0 - alpha);
+    if (t < -1.0) t = -1.0;
+    return std::exp(helper1(t) * x);
+}
+
+uint64_t ZipfSampler::sampleRejection(WorkloadRng& rng) const {
+    while (true) {
+        double u = h_integral_n + rng.unit() * (h_integral_x1 - h_integral_n);
+        double x = hIntegralInverse(u);
+        uint64_t k = (uint64_t)(x + 0.5);
+        if (k < 1) k = 1;
+        if (k > n) k = n;
+        if (k - x <= s || u >= hIntegral(k + 0.5) - h((double)k)) return k - 1;
+    }
+}
+
+bool parseAddressPattern(const std::string& name, AddressPattern& pattern) {
+    if (name == "sequential") {
+        pattern = AddressPattern::SEQUENTIAL;
+    } else if (name == "strided") {
+        pattern = AddressPattern::STRIDED;
+    } else if (name == "uniform") {
+        pattern = AddressPattern::UNIFORM;
+    } else if (name == "zipf") {
+        pattern = AddressPattern::ZIPF;
+    } else if (name == "pointer_chase") {
+        pattern = AddressPattern::POINTER_CHASE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* addressPatternName(AddressPattern pattern) {
+    switch (pattern) {
+        case AddressPattern::SEQUENTIAL: return "sequential";
+        case AddressPattern::STRIDED: return "strided";
+        case AddressPattern::UNIFORM: return "uniform";
+        case AddressPattern::ZIPF: return "zipf";
+        case AddressPattern::POINTER_CHASE: return "pointer_chase";
+    }
+    return "unknown";
+}
+
+AddressGenerator::AddressGenerator(const AddressStreamConfig& _config)
+    : config(_config), rng(_config.seed), phase_base(_config.base), phase_left(_config.phase_length), position(0)
+{
+    if (config.granule == 0) config.granule = 1;
+    if (config.working_set < config.granule) config.working_set = config.granule;
+    if (config.stride == 0) config.stride = config.granule;
+    items = config.working_set / config.granule;
+    if (config.pattern == AddressPattern::ZIPF) zipf = std::make_unique<ZipfSampler>(items, config.alpha);
+
+    double ratio = std::min(std::max(config.write_ratio, 0.0), 1.0);
+    write_threshold = (ratio >= 1.0) ? ~0ULL : (uint64_t)(ratio * 18446744073709551616.0);
+
+    if (config.pattern == AddressPattern::POINTER_CHASE) {
+        // Sattolo's algorithm: a single cycle through every granule
+        items = std::min(items, MAX_CHASE_ITEMS);
+        chase_next.resize(items);
+        for (uint64_t i = 0; i < items; ++i) chase_next[i] = (uint32_t)i;
+        for (uint64_t i = items - 1; i > 0; --i) std::swap(chase_next[i], chase_next[rng.below(i)]);
+    }
+}
+
+void AddressGenerator::fill(unsigned long long* out, AccessType* types, size_t max) {
+    size_t done = 0;
+    while (done < max) {
+        // generate up to the end of the current phase with the pattern's own tight loop
+        size_t n = max - done;
+        if (config.phase_length > 0) {
+            if (phase_left == 0) {
+                phase_base += config.working_set;
+                phase_left = config.phase_length;
+                position = 0;
+            }
+            n = std::min(n, phase_left);
+            phase_left -= n;
+        }
+
+        unsigned long long* dst = out + done;
+        const unsigned long long base = phase_base;
+        switch (config.pattern) {
+            case AddressPattern::SEQUENTIAL:
+            case AddressPattern::STRIDED: {
+                const uint64_t step = (config.pattern == AddressPattern::SEQUENTIAL) ? 8 : config.stride;
+                const uint64_t ws = config.working_set;
+                for (size_t i = 0; i < n; ++i) {
+                    dst[i] = base + position;
+                    position += step;
+                    if (position >= ws) position %= ws;
+                }
+                break;
+            }
+            case AddressPattern::UNIFORM:
+                for (size_t i = 0; i < n; ++i) dst[i] = base + rng.below(items) * config.granule;
+                break;
+            case AddressPattern::ZIPF:
+                for (size_t i = 0; i < n; ++i) dst[i] = base + zipf->sample(rng) * config.granule;
+                break;
+            case AddressPattern::POINTER_CHASE:
+                for (size_t i = 0; i < n; ++i) {
+                    position = chase_next[position];
+                    dst[i] = base + position * config.granule;
+                }
+                break;
+        }
+
+        if (types) {
+            AccessType* t = types + done;
+            if (write_threshold == 0) {
+                std::fill(t, t + n, AccessType::LOAD);
+            } else {
+                for (size_t i = 0; i < n; ++i) t[i] = (rng.next() < write_threshold) ? AccessType::STORE : AccessType::LOAD;
+            }
+        }
+        done += n;
+    }
+}
+
+bool parseSizeDistribution(const std::string& name, SizeDistribution& dist) {
+    if (name == "fixed") {
+        dist = SizeDistribution::FIXED;
+    } else if (name == "uniform") {
+        dist = SizeDistribution::UNIFORM;
+    } else if (name == "exp" || name == "exponential") {
+        dist = SizeDistribution::EXPONENTIAL;
+    } else if (name == "pow2") {
+        dist = SizeDistribution::POWER_OF_TWO;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+AllocationGenerator::AllocationGenerator(const AllocationStreamConfig& _config)
+    : config(_config), rng(_config.seed), now(0), next_handle(0)
+{
+    if (config.min_size == 0) config.min_size = 1;
+    if (config.max_size < config.min_size) config.max_size = config.min_size;
+    if (config.mean_lifetime < 1.0) config.mean_lifetime = 1.0;
+}
+
+size_t AllocationGenerator::drawSize() {
+    switch (config.sizes) {
+        case SizeDistribution::FIXED:
+            return config.min_size;
+        case SizeDistribution::UNIFORM:
+            return config.min_size + rng.below(config.max_size - config.min_size + 1);
+        case SizeDistribution::EXPONENTIAL: {
+            double size = -std::log(1.0 - rng.unit()) * config.mean_size;
+            return std::min(std::max((size_t)size, config.min_size), config.max_size);
+        }
+        case SizeDistribution::POWER_OF_TWO: {
+            int low = (int)floorLog2(nextPowerOf2(config.min_size));
+            int high = (int)floorLog2(config.max_size);
+            if (high < low) high = low;
+            return (size_t)1 << (low + rng.below(high - low + 1));
+        }
+    }
+    return config.min_size;
+}
+
+uint64_t AllocationGenerator::drawLifetime() {
+    if (config.fixed_lifetime) return (uint64_t)config.mean_lifetime;
+    return 1 + (uint64_t)(-std::log(1.0 - rng.unit()) * config.mean_lifetime);
+}
+
+void AllocationGenerator::fill(AllocOp* out, size_t max) {
+    for (size_t i = 0; i < max; ++i, ++now) {
+        if (!deaths.empty() && deaths.top().time <= now) {
+            uint32_t handle = deaths.top().handle;
+            deaths.pop();
+            free_handles.push_back(handle);
+            out[i] = {AllocOpType::FREE, handle, 0, now};
+            continue;
+        }
+
+        uint32_t handle;
+        if (!free_handles.empty()) {
+            handle = free_handles.back();
+            free_handles.pop_back();
+        } else {
+            handle = next_handle++;
+        }
+        out[i] = {AllocOpType::MALLOC, handle, drawSize(), now};
+        deaths.push({now + drawLifetime(), handle});
+    }
+}
+
+int& AllocationDriver::blockSlot(uint32_t handle) {
+    if (handle >= DENSE_HANDLES) return sparse_ids.emplace(handle, -1).first->second;
+    if (handle >= block_ids.size()) {
+        block_ids.resize(std::max<size_t>((size_t)handle + 1, std::min<size_t>(block_ids.size() * 2, DENSE_HANDLES)), -1);
+    }
+    return block_ids[handle];
+}
+
+void AllocationDriver::apply(const AllocOp* ops, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        const AllocOp& op = ops[i];
+        if (op.handle >= handle_limit) {
+            stats.malformed++;
+            continue;
+        }
+        int& id = blockSlot(op.handle);
+        if (op.op == AllocOpType::FREE) {
+            if (id >= 0) {
+                heap.my_free(id);
+                stats.frees++;
+            }
+            id = -1;
+            if (op.handle >= DENSE_HANDLES) sparse_ids.erase(op.handle);
+        } else {
+            // realloc, or a handle reused without a free: drop the old block
+            if (id >= 0) heap.my_free(id);
+            id = heap.my_malloc(op.size);
+            if (op.op == AllocOpType::REALLOC) {
+                stats.reallocs++;
+            } else {
+                stats.mallocs++;
+            }
+            if (id < 0) stats.failures++;
+        }
+    }
+}
+
+void AllocationDriver::applyBatch(const AllocOp* ops, size_t count) {
+    if (!sampler) {
+        apply(ops, count);
+        return;
+    }
+    // split at interval boundaries so every row sees exactly N more operations
+    size_t done = 0;
+    while (done < count) {
+        size_t n = (size_t)std::min<unsigned long long>(count - done, sampler->untilNextSample());
+        apply(ops + done, n);
+        sampler->advance(n, nullptr, nullptr, &heap);
+        done += n;
+    }
+}
+
+void AllocationDriver::run(AllocationGenerator& generator, size_t count) {
+    bool was_verbose = heap.isVerbose();
+    heap.setVerbose(false);
+
+    std::vector<AllocOp> batch(std::min(count, ALLOC_BATCH));
+    auto start = std::chrono::steady_clock::now();
+    for (size_t done = 0; done < count;) {
+        size_t n = std::min(count - done, batch.size());
+        generator.fill(batch.data(), n);
+        applyBatch(batch.data(), n);
+        done += n;
+    }
+    auto end = std::chrono::steady_clock::now();
+    stats.seconds += std::chrono::duration<double>(end - start).count();
+
+    heap.setVerbose(was_verbose);
+}
+
+void AllocationDriver::printStats() const {
+    size_t ops = stats.mallocs + stats.frees + stats.reallocs;
+    double rate = (stats.seconds > 0.0) ? ops / stats.seconds : 0.0;
+    std::cout << "Allocation Workload:\n"
+              << "  Mallocs: " << stats.mallocs << "  Frees: " << stats.frees << "  Reallocs: " << stats.reallocs
+              << "  (" << stats.failures << " failed)\n";
+    if (stats.malformed > 0) std::cout << "  Malformed records skipped: " << stats.malformed << "\n";
+    // wall-clock figures go to stderr so redirected test logs stay reproducible
+    std::cerr << "  Elapsed: " << std::fixed << std::setprecision(3) << stats.seconds << " s"
+              << " (" << std::setprecision(2) << rate / 1e6 << " M ops/s)" << std::endl;
+}
+
+bool parseAddressOptions(const std::vector<std::string>& options, AddressStreamConfig& config) {
+    for (const std::string& option : options) {
+        std::string key, value;
+        if (!splitOption(option, key, value)) return false;
+        unsigned long long number = 0;
+        if (key == "ws" || key == "granule" || key == "stride" || key == "phase" || key == "base" || key == "seed") {
+            if (!parseSize(value, number)) return badValue(key, value);
+            if (key == "ws") config.working_set = number;
+            else if (key == "granule") config.granule = number;
+            else if (key == "stride") config.stride = number;
+            else if (key == "phase") config.phase_length = number;
+            else if (key == "base") config.base = number;
+            else config.seed = number;
+        } else if (key == "alpha") {
+            if (!parseDouble(value, config.alpha) || config.alpha <= 0.0) return badValue(key, value);
+        } else if (key == "writes") {
+            if (!parseDouble(value, config.write_ratio) || config.write_ratio < 0.0 || config.write_ratio > 1.0) {
+                return badValue(key, value);
+            }
+        } else {
+            std::cout << "Error: Unknown option '" << key << "' (ws, granule, stride, alpha, writes, phase, base, seed)" << std::endl;
+            return false;
+        }
+    }
+    if (config.working_set == 0 || config.granule == 0) return badValue("ws/granule", "0");
+    if (config.pattern == AddressPattern::POINTER_CHASE && config.working_set / config.granule > AddressGenerator::MAX_CHASE_ITEMS) {
+        std::cout << "Error: pointer_chase supports at most " << AddressGenerator::MAX_CHASE_ITEMS
+                  << " granules (ws/granule); use a smaller ws or a larger granule" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool parseAllocationOptions(const std::vector<std::string>& options, AllocationStreamConfig& config) {
+    for (const std::string& option : options) {
+        std::string key, value;
+        if (!splitOption(option, key, value)) return false;
+        unsigned long long number = 0;
+        if (key == "dist") {
+            if (!parseSizeDistribution(value, config.sizes)) return badValue(key, value);
+        } else if (key == "lifetime") {
+            if (value != "exp" && value != "fixed") return badValue(key, value);
+            config.fixed_lifetime = (value == "fixed");
+        } else if (key == "life") {
+            if (!parseDouble(value, config.mean_lifetime) || config.mean_lifetime < 1.0) return badValue(key, value);
+        } else if (key == "min" || key == "max" || key == "mean" || key == "seed") {
+            if (!parseSize(value, number)) return badValue(key, value);
+            if (key == "min") config.min_size = number;
+            else if (key == "max") config.max_size = number;
+            else if (key == "mean") config.mean_size = number;
+            else config.seed = number;
+        } else {
+            std::cout << "Error: Unknown option '" << key << "' (dist, min, max, mean, life, lifetime, seed)" << std::endl;
+            return false;
+        }
+    }
+    if (config.min_size == 0 || config.max_size < config.min_size) return badValue("min/max", std::to_string(config.min_size));
+    return true;
+}
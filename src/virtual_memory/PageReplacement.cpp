@@ -0,0 +1,328 @@
+#include "../../include/PageReplacementPolicies.h"
+#include "../../include/PageTable.h"
+#include <algorithm>
+
+// FrameList
+void FrameList::init(size_t num_frames) {
+    prev_frame.assign(num_frames, -1);
+    next_frame.assign(num_frames, -1);
+    linked.assign(num_frames, 0);
+    head = tail = -1;
+    count = 0;
+}
+
+void FrameList::pushBack(int frame) {
+    prev_frame[frame] = tail;
+    next_frame[frame] = -1;
+    if (tail >= 0) next_frame[tail] = frame;
+    else head = frame;
+    tail = frame;
+    linked[frame] = 1;
+    count++;
+}
+
+void FrameList::remove(int frame) {
+    int p = prev_frame[frame];
+    int n = next_frame[frame];
+    if (p >= 0) next_frame[p] = n;
+    else head = n;
+    if (n >= 0) prev_frame[n] = p;
+    else tail = p;
+    linked[frame] = 0;
+    count--;
+}
+
+void FrameList::moveToBack(int frame) {
+    if (frame == tail) return;
+    remove(frame);
+    pushBack(frame);
+}
+
+// GhostList
+void GhostList::pushBack(unsigned long long vpn) {
+    order.push_back(vpn);
+    position[vpn] = std::prev(order.end());
+}
+
+void GhostList::remove(unsigned long long vpn) {
+    auto it = position.find(vpn);
+    if (it == position.end()) return;
+    order.erase(it->second);
+    position.erase(it);
+}
+
+void GhostList::popFront() {
+    if (order.empty()) return;
+    position.erase(order.front());
+    order.pop_front();
+}
+
+void GhostList::clear() {
+    order.clear();
+    position.clear();
+}
+
+// FIFO
+void FIFOPolicy::init(size_t num_frames, const std::vector<PageTableEntry*>*) {
+    queue.init(num_frames);
+}
+
+void FIFOPolicy::onLoad(int frame, unsigned long long) {
+    queue.pushBack(frame);
+}
+
+void FIFOPolicy::onAccess(int) {
+    // FIFO records order of *loading*, not access
+}
+
+int FIFOPolicy::selectVictim(unsigned long long) {
+    int victim = queue.front();
+    queue.remove(victim);
+    return victim;
+}
+
+std::string FIFOPolicy::getName() const {
+    return "FIFO";
+}
+
+// LRU
+void LRUPolicy::init(size_t num_frames, const std::vector<PageTableEntry*>*) {
+    recency.init(num_frames);
+}
+
+void LRUPolicy::onLoad(int frame, unsigned long long) {
+    recency.pushBack(frame);
+}
+
+void LRUPolicy::onAccess(int frame) {
+    recency.moveToBack(frame);
+}
+
+int LRUPolicy::selectVictim(unsigned long long) {
+    int victim = recency.front();
+    recency.remove(victim);
+    return victim;
+}
+
+std::string LRUPolicy::getName() const {
+    return "LRU";
+}
+
+// Clock
+void ClockPolicy::init(size_t _num_frames, const std::vector<PageTableEntry*>* frame_ptes) {
+    ptes = frame_ptes;
+    num_frames = _num_frames;
+    hand = 0;
+}
+
+void ClockPolicy::onLoad(int, unsigned long long) {
+    // the reference bit is set in the PTE by the access that faulted the page in
+}
+
+void ClockPolicy::onAccess(int) {
+    // hardware sets the reference bit in the PTE; nothing to track here
+}
+
+int ClockPolicy::selectVictim(unsigned long long) {
+    // terminates within two sweeps: the first clears every reference bit it passes
+    while (true) {
+        PageTableEntry* pte = (*ptes)[hand];
+        size_t frame = hand;
+        hand = (hand + 1) % num_frames;
+        if (!pte->referenced) return (int)frame;
+        pte->referenced = false;
+    }
+}
+
+std::string ClockPolicy::getName() const {
+    return "Clock";
+}
+
+// Enhanced Second-Chance
+int SecondChancePolicy::selectVictim(unsigned long long) {
+    while (true) {
+        // sweep 1: unreferenced and clean, bits untouched
+        for (size_t i = 0; i < num_frames; ++i) {
+            size_t frame = (hand + i) % num_frames;
+            const PageTableEntry* pte = (*ptes)[frame];
+            if (!pte->referenced && !pte->dirty) {
+                hand = (frame + 1) % num_frames;
+                return (int)frame;
+            }
+        }
+        // sweep 2: unreferenced but dirty, clearing reference bits on the way
+        for (size_t i = 0; i < num_frames; ++i) {
+            size_t frame = (hand + i) % num_frames;
+            PageTableEntry* pte = (*ptes)[frame];
+            if (!pte->referenced && pte->dirty) {
+                hand = (frame + 1) % num_frames;
+                return (int)frame;
+            }
+            pte->referenced = false;
+        }
+        // every page was referenced: all bits are clear now, the next round succeeds
+    }
+}
+
+std::string SecondChancePolicy::getName() const {
+    return "Enhanced Second-Chance";
+}
+
+// 2Q
+void TwoQueuePolicy::init(size_t num_frames, const std::vector<PageTableEntry*>*) {
+    a1_in.init(num_frames);
+    am.init(num_frames);
+    a1_out.clear();
+    frame_vpn.assign(num_frames, 0);
+    k_in = std::max<size_t>(1, num_frames / 4);
+    k_out = std::max<size_t>(1, num_frames / 2);
+}
+
+void TwoQueuePolicy::onLoad(int frame, unsigned long long vpn) {
+    frame_vpn[frame] = vpn;
+    if (a1_out.contains(vpn)) {
+        // re-referenced after leaving A1in: a hot page
+        a1_out.remove(vpn);
+        am.pushBack(frame);
+    } else {
+        a1_in.pushBack(frame);
+    }
+}
+
+void TwoQueuePolicy::onAccess(int frame) {
+    // hits inside A1in are ignored (correlated references); Am is LRU
+    if (am.contains(frame)) am.moveToBack(frame);
+}
+
+int TwoQueuePolicy::selectVictim(unsigned long long) {
+    int victim;
+    if (!a1_in.empty() && (a1_in.size() > k_in || am.empty())) {
+        victim = a1_in.front();
+        a1_in.remove(victim);
+        a1_out.pushBack(frame_vpn[victim]);
+        if (a1_out.size() > k_out) a1_out.popFront();
+    } else {
+        victim = am.front();
+        am.remove(victim);
+    }
+    return victim;
+}
+
+std::string TwoQueuePolicy::getName() const {
+    return "2Q";
+}
+
+// ARC
+void ARCPolicy::init(size_t num_frames, const std::vector<PageTableEntry*>*) {
+    t1.init(num_frames);
+    t2.init(num_frames);
+    b1.clear();
+    b2.clear();
+    frame_vpn.assign(num_frames, 0);
+    capacity = num_frames;
+    p = 0;
+    load_to_t2 = false;
+}
+
+void ARCPolicy::onLoad(int frame, unsigned long long vpn) {
+    frame_vpn[frame] = vpn;
+    if (load_to_t2) {
+        t2.pushBack(frame);
+        load_to_t2 = false;
+    } else {
+        t1.pushBack(frame);
+    }
+}
+
+void ARCPolicy::onAccess(int frame) {
+    // any hit makes the page frequent
+    if (t1.contains(frame)) {
+        t1.remove(frame);
+        t2.pushBack(frame);
+    } else {
+        t2.moveToBack(frame);
+    }
+}
+
+int ARCPolicy::evictFrom(FrameList& list, GhostList* ghost) {
+    int victim = list.front();
+    list.remove(victim);
+    if (ghost) ghost->pushBack(frame_vpn[victim]);
+    return victim;
+}
+
+int ARCPolicy::replace(bool incoming_in_b2) {
+    if (!t1.empty() && ((incoming_in_b2 && t1.size() == p) || t1.size() > p || t2.empty())) {
+        return evictFrom(t1, &b1);
+    }
+    return evictFrom(t2, &b2);
+}
+
+int ARCPolicy::selectVictim(unsigned long long incoming_vpn) {
+    if (b1.contains(incoming_vpn)) {
+        // recency ghost hit: grow T1's target
+        size_t delta = std::max<size_t>(1, b2.size() / b1.size());
+        p = std::min(capacity, p + delta);
+        b1.remove(incoming_vpn);
+        load_to_t2 = true;
+        return replace(false);
+    }
+    if (b2.contains(incoming_vpn)) {
+        // frequency ghost hit: shrink T1's target
+        size_t delta = std::max<size_t>(1, b1.size() / b2.size());
+        p = (p > delta) ? p - delta : 0;
+        b2.remove(incoming_vpn);
+        load_to_t2 = true;
+        return replace(true);
+    }
+
+    // brand new page
+    load_to_t2 = false;
+    if (t1.size() + b1.size() >= capacity) {
+        if (t1.size() < capacity) {
+            b1.popFront();
+            return replace(false);
+        }
+        return evictFrom(t1, nullptr); // B1 is empty: drop the LRU page of T1 outright
+    }
+    if (t1.size() + t2.size() + b1.size() + b2.size() >= 2 * capacity) {
+        b2.popFront();
+    }
+    return replace(false);
+}
+
+std::string ARCPolicy::getName() const {
+    return "ARC";
+}
+
+// OPT
+void OptimalPolicy::init(size_t num_frames, const std::vector<PageTableEntry*>*) {
+    frame_next_use.assign(num_frames, 0);
+    by_next_use.clear();
+}
+
+void OptimalPolicy::update(int frame) {
+    by_next_use.erase(std::make_pair(frame_next_use[frame], frame));
+    frame_next_use[frame] = next_use;
+    by_next_use.emplace(next_use, frame);
+}
+
+void OptimalPolicy::onLoad(int frame, unsigned long long) {
+    frame_next_use[frame] = next_use;
+    by_next_use.emplace(next_use, frame);
+}
+
+void OptimalPolicy::onAccess(int frame) {
+    update(frame);
+}
+
+int OptimalPolicy::selectVictim(unsigned long long) {
+    auto furthest = std::prev(by_next_use.end());
+    int victim = furthest->second;
+    by_next_use.erase(furthest);
+    return victim;
+}
+
+std::string OptimalPolicy::getName() const {
+    return "OPT";
+}
@@ -1,43 +1,202 @@
-#include "../include/PageTable.h"
+#include "../../include/PageTable.h"
+#include "../../include/PageReplacementPolicies.h"
+#include "../buddy/BuddyUtils.h"
 
-VirtualMemoryManager::VirtualMemoryManager(size_t phys_size, size_t pg_size)
-    : page_size(pg_size), physical_memory_size(phys_size), page_faults(0), page_hits(0) 
+namespace {
+const unsigned DEFAULT_LEVEL_BITS = 9;  // 512 entries per node, as on x86-64
+const unsigned MAX_LEVEL_BITS = 16;     // caps node size when few levels are requested
+}
+
+bool VirtualMemoryManager::levelsFit(size_t pg_size, int levels) {
+    if (levels <= 0) return true;
+    unsigned vpn_bits = 64 - floorLog2(isPowerOf2(pg_size) ? pg_size : nextPowerOf2(pg_size));
+    if ((unsigned)levels > vpn_bits) return false;
+    unsigned bits = (vpn_bits + levels - 1) / levels;
+    return bits * (unsigned)(levels - 1) < vpn_bits;
+}
+
+VirtualMemoryManager::VirtualMemoryManager(size_t phys_size, size_t pg_size, int _levels, bool _verbose)
+    : page_size(pg_size), physical_memory_size(phys_size), table_nodes(0), page_faults(0), page_hits(0), disk_writes(0), verbose(_verbose)
 {
+    if (!isPowerOf2(page_size)) {
+        size_t rounded = nextPowerOf2(page_size);
+        std::cout << "Warning: Page size must be a power of 2. Resizing " << page_size << " -> " << rounded << std::endl;
+        page_size = rounded;
+    }
+    page_shift = floorLog2(page_size);
+
+    // split the VPN bits over the levels
+    unsigned vpn_bits = 64 - page_shift;
+    if (_levels <= 0) {
+        _levels = (vpn_bits + DEFAULT_LEVEL_BITS - 1) / DEFAULT_LEVEL_BITS;
+    }
+    unsigned min_levels = (vpn_bits + MAX_LEVEL_BITS - 1) / MAX_LEVEL_BITS;
+    if ((unsigned)_levels < min_levels) {
+        std::cout << "Warning: " << _levels << " levels would need nodes over 2^" << MAX_LEVEL_BITS
+                  << " entries. Using " << min_levels << " levels." << std::endl;
+        _levels = min_levels;
+    }
+    if ((unsigned)_levels > vpn_bits) _levels = vpn_bits;
+    levels = _levels;
+    bits_per_level = (vpn_bits + levels - 1) / levels;
+    if (bits_per_level * (levels - 1) >= vpn_bits) {
+        // rounding up left nothing for the root; drop the empty top levels
+        int fit = (vpn_bits + bits_per_level - 1) / bits_per_level;
+        std::cout << "Warning: " << levels << " levels leave no bits for the root table. Using "
+                  << fit << " levels." << std::endl;
+        levels = fit;
+    }
+    walk_refs.assign(levels, 0);
+    root.reset(newNode(0));
+    configureTLB(64, 4, 1024, 8, ReplacementPolicy::LRU);
+
     num_frames = physical_memory_size / page_size;
-    frame_table.resize(num_frames, -1); // initialize all frames as free (-1)
+    if (num_frames == 0) {
+        std::cout << "Warning: Physical memory smaller than one page. Using 1 frame." << std::endl;
+        num_frames = 1;
+    }
+    frame_table.resize(num_frames, NO_VPN); // initialize all frames as free
+    frame_ptes.resize(num_frames, nullptr);
+    replacement = std::make_unique<FIFOPolicy>();
+    replacement->init(num_frames, &frame_ptes);
+    replacement_type = "fifo";
 
     // add all frames to free list
     for (size_t i = 0; i < num_frames; ++i) {
         free_frames.push_back(i);
     }
     
-    std::cout << "Virtual Memory Initialized: " << num_frames << " Frames of size " << page_size << std::endl;
+    if (verbose) std::cout << "Virtual Memory Initialized: " << num_frames << " Frames of size " << page_size << std::endl;
+}
+
+PageTableNode* VirtualMemoryManager::newNode(int level) {
+    // the root takes the bits left over above the lower levels
+    unsigned bits = bits_per_level;
+    if (level == 0) {
+        bits = (64 - page_shift) - bits_per_level * (levels - 1);
+    }
+
+    PageTableNode* node = new PageTableNode();
+    if (level == levels - 1) {
+        node->entries.resize((size_t)1 << bits);
+    } else {
+        node->children.resize((size_t)1 << bits);
+    }
+    table_nodes++;
+    return node;
+}
+
+unsigned VirtualMemoryManager::indexAt(unsigned long long vpn, int level) const {
+    unsigned shift = bits_per_level * (levels - 1 - level);
+    unsigned long long index = vpn >> shift;
+    if (level > 0) index &= ((1ULL << bits_per_level) - 1);
+    return (unsigned)index;
+}
+
+PageTableEntry* VirtualMemoryManager::walk(unsigned long long vpn) {
+    PageTableNode* node = root.get();
+    for (int level = 0; level < levels - 1; ++level) {
+        walk_refs[level]++;
+        PageTableNode* child = node->children[indexAt(vpn, level)].get();
+        if (!child) return nullptr;
+        node = child;
+    }
+    walk_refs[levels - 1]++;
+    return &node->entries[indexAt(vpn, levels - 1)];
 }
 
-unsigned long long VirtualMemoryManager::translate(unsigned long long v_addr) {
-    int vpn = v_addr / page_size;
-    int offset = v_addr % page_size;
+PageTableEntry* VirtualMemoryManager::findEntry(unsigned long long vpn, bool create) {
+    PageTableNode* node = root.get();
+    for (int level = 0; level < levels - 1; ++level) {
+        std::unique_ptr<PageTableNode>& child = node->children[indexAt(vpn, level)];
+        if (!child) {
+            if (!create) return nullptr;
+            child.reset(newNode(level + 1));
+        }
+        node = child.get();
+    }
+    return &node->entries[indexAt(vpn, levels - 1)];
+}
+
+void VirtualMemoryManager::configureTLB(size_t l1_entries, size_t l1_assoc, size_t l2_entries, size_t l2_assoc, ReplacementPolicy policy) {
+    if (l1_entries == 0) {
+        tlb.reset();
+        return;
+    }
+    tlb = std::make_unique<TLB>(l1_entries, l1_assoc, l2_entries, l2_assoc, policy);
+}
+
+void VirtualMemoryManager::setReplacementPolicy(const std::string& type) {
+    std::unique_ptr<PageReplacementPolicy> policy;
+    std::string key = type;
+    if (type == "fifo") {
+        policy = std::make_unique<FIFOPolicy>();
+    } else if (type == "lru") {
+        policy = std::make_unique<LRUPolicy>();
+    } else if (type == "clock") {
+        policy = std::make_unique<ClockPolicy>();
+    } else if (type == "second_chance") {
+        policy = std::make_unique<SecondChancePolicy>();
+    } else if (type == "2q") {
+        policy = std::make_unique<TwoQueuePolicy>();
+    } else if (type == "arc") {
+        policy = std::make_unique<ARCPolicy>();
+    } else {
+        std::cout << "Unknown page replacement policy. Defaulting to FIFO." << std::endl;
+        policy = std::make_unique<FIFOPolicy>();
+        key = "fifo";
+    }
+    setReplacementPolicy(std::move(policy), key);
+}
+
+void VirtualMemoryManager::setReplacementPolicy(std::unique_ptr<PageReplacementPolicy> policy, const std::string& type) {
+    replacement = std::move(policy);
+    replacement_type = type;
+
+    // seed the new policy with the pages already resident, in frame order
+    replacement->init(num_frames, &frame_ptes);
+    for (size_t frame = 0; frame < num_frames; ++frame) {
+        if (frame_table[frame] != NO_VPN) replacement->onLoad((int)frame, frame_table[frame]);
+    }
+    if (verbose) std::cout << "Page replacement policy set to " << replacement->getName() << std::endl;
+}
+
+unsigned long long VirtualMemoryManager::translate(unsigned long long v_addr, bool is_write) {
+    unsigned long long vpn = v_addr >> page_shift;
+    unsigned long long offset = v_addr & (page_size - 1);
+
+    // TLB hit: no page walk
+    int pfn;
+    if (tlb && tlb->lookup(vpn, pfn)) {
+        page_hits++;
+        touchFrame(pfn, is_write);
+        return ((unsigned long long)pfn << page_shift) | offset;
+    }
 
     // check Page Table
-    if (page_table.find(vpn) != page_table.end() && page_table[vpn].valid) {
+    PageTableEntry* pte = walk(vpn);
+    if (pte && pte->valid) {
         // Hit
         page_hits++;
-        int pfn = page_table[vpn].frame_number;
-        // move to back? No, that's LRU. FIFO records order of *loading*, not access.
-        return (unsigned long long)pfn * page_size + offset;
+        touchFrame(pte->frame_number, is_write);
+        if (tlb) tlb->insert(vpn, pte->frame_number);
+        return ((unsigned long long)pte->frame_number << page_shift) | offset;
     }
 
     // Misss -> Page Fault
-    std::cout << "  > Page Fault for VPN " << vpn << std::endl;
+    if (verbose) std::cout << "  > Page Fault for VPN " << vpn << std::endl;
     page_faults++;
     handlePageFault(vpn);
 
     // retry translation known to be valid now
-    int pfn = page_table[vpn].frame_number;
-    return (unsigned long long)pfn * page_size + offset;
+    pte = findEntry(vpn, false);
+    if (is_write) pte->dirty = true;
+    pfn = pte->frame_number;
+    if (tlb) tlb->insert(vpn, pfn);
+    return ((unsigned long long)pfn << page_shift) | offset;
 }
 
-void VirtualMemoryManager::handlePageFault(int vpn) {
+void VirtualMemoryManager::handlePageFault(unsigned long long vpn) {
     int frame_idx = -1;
 
     // 1. Check if there is a free frame
@@ -46,61 +205,101 @@ void VirtualMemoryManager::handlePageFault(int vpn) {
         free_frames.pop_front();
     } 
     else {
-        // 2. No free frames -> Eviction (FIFO)
-        if (present_pages_fifo.empty()) {
-            std::cerr << "Criticial Error: No pages to evict but no free frames?" << std::endl;
-            return;
-        }
+        // 2. No free frames -> Eviction (policy picks the victim frame)
+        frame_idx = replacement->selectVictim(vpn);
 
-        // Simulate Disk Access Latency (Symbolic)
-        std::cout << "  [Disk Access] Saving victim page to disk... (Latency simulated)" << std::endl;
+        unsigned long long victim_vpn = frame_table[frame_idx];
+        PageTableEntry* victim = frame_ptes[frame_idx];
 
-        // Pop the first loaded page
-        int victim_vpn = present_pages_fifo.front();
-        present_pages_fifo.pop_front();
+        // Simulate Disk Access Latency (Symbolic); a clean page still matches its copy on disk
+        if (victim->dirty) {
+            disk_writes++;
+            if (verbose) std::cout << "  [Disk Access] Saving dirty victim page to disk... (Latency simulated)" << std::endl;
+        } else if (verbose) {
+            std::cout << "  > Victim page is clean, skipping disk write" << std::endl;
+        }
 
         // Invalidate victim in Page Table
-        if (page_table.count(victim_vpn)) {
-            page_table[victim_vpn].valid = false;
-            frame_idx = page_table[victim_vpn].frame_number;
-            std::cout << "  > Evicting VPN " << victim_vpn << " from Frame " << frame_idx << std::endl;
-        }
+        victim->valid = false;
+        victim->dirty = false;
+        if (tlb) tlb->shootdown(victim_vpn);
+        if (verbose) std::cout << "  > Evicting VPN " << victim_vpn << " from Frame " << frame_idx << std::endl;
     }
 
     // 3. Load new page into frame
-    PageTableEntry pte;
-    pte.valid = true;
-    pte.frame_number = frame_idx;
+    PageTableEntry* pte = findEntry(vpn, true);
+    pte->valid = true;
+    pte->referenced = true; // the faulting access
+    pte->dirty = false;
+    pte->frame_number = frame_idx;
     
-    page_table[vpn] = pte;
     frame_table[frame_idx] = vpn; // record owner
-    present_pages_fifo.push_back(vpn); // add to FIFO queue
+    frame_ptes[frame_idx] = pte;
+    replacement->onLoad(frame_idx, vpn);
     
-    // Simulate Disk Access Latency for Loading
-    std::cout << "  [Disk Access] Loading page " << vpn << " from disk... (Latency simulated)" << std::endl;
+    if (verbose) {
+        // Simulate Disk Access Latency for Loading
+        std::cout << "  [Disk Access] Loading page " << vpn << " from disk... (Latency simulated)" << std::endl;
 
-    std::cout << "  > Loaded VPN " << vpn << " into Frame " << frame_idx << std::endl;
+        std::cout << "  > Loaded VPN " << vpn << " into Frame " << frame_idx << std::endl;
+    }
+}
+
+size_t VirtualMemoryManager::getWalkReferences() const {
+    size_t total_refs = 0;
+    for (size_t refs : walk_refs) total_refs += refs;
+    return total_refs;
 }
 
 void VirtualMemoryManager::printStats() const {
     size_t total = page_faults + page_hits;
     double fault_rate = (total > 0) ? (double)page_faults / total * 100.0 : 0.0;
 
+    size_t total_refs = getWalkReferences();
+    double refs_per_walk = (total > 0) ? (double)total_refs / total : 0.0;
+
     std::cout << "Virtual Memory Statistics:\n"
               << "  Page Hits:   " << page_hits << "\n"
               << "  Page Faults: " << page_faults << "\n"
-              << "  Fault Rate:  " << std::fixed << std::setprecision(2) << fault_rate << "%\n";
+              << "  Fault Rate:  " << std::fixed << std::setprecision(2) << fault_rate << "%\n"
+              << "  Disk Writes: " << disk_writes << " (dirty evictions)\n"
+              << "  Policy:      " << replacement->getName() << "\n"
+              << "  Page Table:  " << levels << " levels x " << bits_per_level << " bits, "
+              << table_nodes << " nodes allocated\n"
+              << "  Walk Refs:   " << total_refs << " (" << refs_per_walk << " per translation)\n";
+    for (int level = 0; level < levels; ++level) {
+        std::cout << "    L" << level << ": " << walk_refs[level] << "\n";
+    }
+    if (tlb) {
+        tlb->printStats();
+    } else {
+        std::cout << "  TLB: disabled\n";
+    }
+}
+
+void VirtualMemoryManager::printNode(const PageTableNode* node, int level, unsigned long long vpn_prefix) const {
+    if (level == levels - 1) {
+        for (size_t i = 0; i < node->entries.size(); ++i) {
+            const PageTableEntry& pte = node->entries[i];
+            if (pte.valid) {
+                std::cout << "  " << std::setw(5) << ((vpn_prefix << bits_per_level) | i) << " | " 
+                          << std::setw(5) << pte.frame_number << " | " 
+                          << "YES" << "\n";
+            }
+        }
+        return;
+    }
+    for (size_t i = 0; i < node->children.size(); ++i) {
+        if (node->children[i]) {
+            unsigned long long prefix = (level == 0) ? i : ((vpn_prefix << bits_per_level) | i);
+            printNode(node->children[i].get(), level + 1, prefix);
+        }
+    }
 }
 
 void VirtualMemoryManager::printPageTable() const {
     std::cout << "Page Table Dump (Valid Entries):\n";
     std::cout << "  VPN   | Frame | Valid \n";
     std::cout << "  ------|-------|-------\n";
-    for (const auto& pair : page_table) {
-        if (pair.second.valid) {
-            std::cout << "  " << std::setw(5) << pair.first << " | " 
-                      << std::setw(5) << pair.second.frame_number << " | " 
-                      << "YES" << "\n";
-        }
-    }
+    printNode(root.get(), 0, 0);
 }
@@ -0,0 +1,97 @@
+#include "../../include/TLB.h"
+#include <iomanip>
+
+TLBLevel::TLBLevel(std::string _name, size_t entries, size_t _associativity, ReplacementPolicy _policy)
+    : name(_name), num_entries(entries), associativity(_associativity), num_sets(1), pow2_sets(true), set_mask(0), policy(_policy), clock(0), hits(0), misses(0), shootdowns(0)
+{
+    if (num_entries == 0) num_entries = 1;
+    if (associativity == 0 || associativity > num_entries) associativity = num_entries;
+    num_sets = num_entries / associativity;
+    if (num_sets == 0) num_sets = 1;
+    pow2_sets = (num_sets & (num_sets - 1)) == 0;
+    set_mask = num_sets - 1;
+
+    vpns.assign(num_sets * associativity, INVALID_VPN);
+    pfns.assign(num_sets * associativity, -1);
+    stamps.assign(num_sets * associativity, 0);
+}
+
+bool TLBLevel::lookup(unsigned long long vpn, int& pfn) {
+    const size_t base = setBase(vpn);
+    for (size_t w = 0; w < associativity; ++w) {
+        if (vpns[base + w] == vpn) {
+            hits++;
+            if (policy == ReplacementPolicy::LRU) stamps[base + w] = ++clock;
+            pfn = pfns[base + w];
+            return true;
+        }
+    }
+    misses++;
+    return false;
+}
+
+void TLBLevel::insert(unsigned long long vpn, int pfn) {
+    const size_t base = setBase(vpn);
+    // empty ways have stamp 0 and are picked first
+    size_t victim = 0;
+    for (size_t w = 0; w < associativity; ++w) {
+        if (vpns[base + w] == vpn) {
+            victim = w;
+            break;
+        }
+        if (stamps[base + w] < stamps[base + victim]) victim = w;
+    }
+    vpns[base + victim] = vpn;
+    pfns[base + victim] = pfn;
+    stamps[base + victim] = ++clock;
+}
+
+bool TLBLevel::invalidate(unsigned long long vpn) {
+    const size_t base = setBase(vpn);
+    for (size_t w = 0; w < associativity; ++w) {
+        if (vpns[base + w] == vpn) {
+            vpns[base + w] = INVALID_VPN;
+            stamps[base + w] = 0;
+            shootdowns++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void TLBLevel::printStats() const {
+    size_t total = hits + misses;
+    double miss_rate = (total > 0) ? (double)misses / total * 100.0 : 0.0;
+
+    std::cout << "[" << name << "] Entries: " << num_entries << ", Assoc: " << associativity << std::endl;
+    std::cout << "  Hits: " << hits << "  Misses: " << misses
+              << "  Miss Rate: " << std::fixed << std::setprecision(2) << miss_rate << "%"
+              << "  Shootdowns: " << shootdowns << std::endl;
+}
+
+TLB::TLB(size_t l1_entries, size_t l1_assoc, size_t l2_entries, size_t l2_assoc, ReplacementPolicy policy)
+    : l1("L1 dTLB", l1_entries, l1_assoc, policy), l2("L2 STLB", l2_entries, l2_assoc, policy) {}
+
+bool TLB::lookup(unsigned long long vpn, int& pfn) {
+    if (l1.lookup(vpn, pfn)) return true;
+    if (l2.lookup(vpn, pfn)) {
+        l1.insert(vpn, pfn);
+        return true;
+    }
+    return false;
+}
+
+void TLB::insert(unsigned long long vpn, int pfn) {
+    l1.insert(vpn, pfn);
+    l2.insert(vpn, pfn);
+}
+
+void TLB::shootdown(unsigned long long vpn) {
+    l1.invalidate(vpn);
+    l2.invalidate(vpn);
+}
+
+void TLB::printStats() const {
+    l1.printStats();
+    l2.printStats();
+}
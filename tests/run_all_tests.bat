@@ -17,5 +17,53 @@ echo Running Virtual Memory ^& Cache Test...
 ..\memsim.exe < test_vm.txt > logs\output_vm.txt
 echo Done. Output saved to logs\output_vm.txt
 
+echo Running Page Replacement Policy Test...
+..\memsim.exe < test_vm_policies.txt > logs\output_vm_policies.txt
+echo Done. Output saved to logs\output_vm_policies.txt
+
+echo Running Write Policy Test...
+..\memsim.exe < test_writes.txt > logs\output_writes.txt
+echo Done. Output saved to logs\output_writes.txt
+
+echo Running Cache Hierarchy Test...
+..\memsim.exe < test_hierarchy.txt > logs\output_hierarchy.txt
+echo Done. Output saved to logs\output_hierarchy.txt
+
+echo Running Prefetcher Test...
+..\memsim.exe < test_prefetch.txt > logs\output_prefetch.txt
+echo Done. Output saved to logs\output_prefetch.txt
+
+echo Running Multicore Coherence Test...
+..\memsim.exe < test_multicore.txt > logs\output_multicore.txt
+echo Done. Output saved to logs\output_multicore.txt
+
+echo Running Timing Model Test...
+..\memsim.exe < test_timing.txt > logs\output_timing.txt
+echo Done. Output saved to logs\output_timing.txt
+
+echo Running Metrics Export Test...
+..\memsim.exe < test_metrics.txt > logs\output_metrics.txt
+echo Done. Output saved to logs\output_metrics.txt
+
+echo Running Allocation Trace Test...
+..\memsim.exe < test_alloctrace.txt > logs\output_alloctrace.txt
+echo Done. Output saved to logs\output_alloctrace.txt
+
+echo Running Compact Trace Test...
+..\memsim.exe < test_compact.txt > logs\output_compact.txt
+echo Done. Output saved to logs\output_compact.txt
+
+echo Running Slab Allocator Test...
+..\memsim.exe < test_slab.txt > logs\output_slab.txt
+echo Done. Output saved to logs\output_slab.txt
+
+echo Running TLSF Allocator Test...
+..\memsim.exe < test_tlsf.txt > logs\output_tlsf.txt
+echo Done. Output saved to logs\output_tlsf.txt
+
+echo Running Workload Generator Test...
+..\memsim.exe < test_gen.txt > logs\output_gen.txt
+echo Done. Output saved to logs\output_gen.txt
+
 echo All tests completed.
 pause